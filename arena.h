@@ -0,0 +1,163 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+//allocation policies for persistent nodes
+//a node asks its policy for raw memory when it is made and hands it back
+//when its last reference goes, see ref.h
+
+//the default, plain operator new per node
+struct HeapAlloc
+{
+	static void* allocate (const size_t bytes, const size_t align)
+	{
+		if(align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			return ::operator new(bytes, std::align_val_t(align));
+
+		return ::operator new(bytes);
+	}
+
+	static void deallocate (void* const p, const size_t, const size_t align)
+	{
+		if(align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			return ::operator delete(p, std::align_val_t(align));
+
+		::operator delete(p);
+	}
+};
+
+//thread local bump allocator
+//memory is handed out in big blocks and only ever given back all at once
+//by rewinding to a mark, single nodes are never freed
+class Arena
+{
+	struct Block
+	{
+		Block* const prev;
+		const size_t size;
+		size_t used;
+
+		Block (Block* const p, const size_t s)
+			: prev(p), size(s), used(0)
+		{}
+
+		unsigned char* data (void)
+		{
+			return reinterpret_cast<unsigned char*>(this + 1);
+		}
+	};
+
+	static constexpr size_t blockSize = 64 * 1024;
+
+	Block* top = nullptr;
+
+	Arena (void) = default;
+
+	public:
+
+	struct Mark
+	{
+		Block* const block;
+		const size_t used;
+	};
+
+	Arena (const Arena&) = delete;
+
+	~Arena (void)
+	{
+		rewind(Mark{nullptr, 0});
+	}
+
+	static Arena& local (void)
+	{
+		static thread_local Arena arena;
+		return arena;
+	}
+
+	void* allocate (const size_t bytes, const size_t align)
+	{
+		if(top)
+		{
+			//the block header leaves data() only as aligned as new gave us, so it's the
+			//address that gets rounded up, not the offset
+			void* p = top->data() + top->used;
+			size_t room = top->size - top->used;
+
+			if(std::align(align, bytes, p, room))
+			{
+				top->used = top->size - room + bytes;
+				return p;
+			}
+		}
+
+		//oversized requests get a block of their own, with room to round up to align
+		const size_t size = bytes + align > blockSize ? bytes + align : blockSize;
+		top = new (::operator new(sizeof(Block) + size)) Block(top, size);
+
+		return allocate(bytes, align);
+	}
+
+	Mark mark (void) const
+	{
+		return Mark{top, top ? top->used : 0};
+	}
+
+	//frees every block handed out since m, anything still pointing in there dangles
+	void rewind (const Mark m)
+	{
+		while(top != m.block)
+		{
+			Block* const prev = top->prev;
+
+			top->~Block();
+			::operator delete(top);
+			top = prev;
+		}
+
+		if(top)
+			top->used = m.used;
+	}
+};
+
+//nodes come out of the calling thread's arena
+//node destructors still run when the last reference goes, only the memory waits for the region
+struct ArenaAlloc
+{
+	static void* allocate (const size_t bytes, const size_t align)
+	{
+		return Arena::local().allocate(bytes, align);
+	}
+
+	static void deallocate (void* const, const size_t, const size_t)
+	{}
+};
+
+//scope guard, everything the thread's arena hands out while a region is alive
+//is released in one go when it dies, so nothing built in it may outlive it
+//
+//{
+//	const Region r;
+//	const auto l = Range(input) | Map(f) | Collect< List<int, ListNode<int, ArenaAlloc>>>();
+//	...
+//}
+class Region
+{
+	const Arena::Mark mark;
+
+	public:
+	Region (void)
+		: mark(Arena::local().mark())
+	{}
+
+	Region (const Region&) = delete;
+
+	~Region (void)
+	{
+		Arena::local().rewind(mark);
+	}
+};
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ref.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#include <array>
+#endif
+
+//a block of values stored next to each other and shared rather than copied
+//Chunk in transformers.h groups a stream into these so whole blocks can go through tight loops
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+struct BatchNode : public Counted<Count, Alloc>
+{
+	const std::vector<T> values;
+
+	BatchNode (std::vector<T>&& v)
+		: values(std::move(v))
+	{}
+};
+
+template <typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class Batch
+{
+	using Node = BatchNode<T, Alloc, Count>;
+
+	Ref<Node> node;
+
+	public:
+	using DataType = T;
+
+	Batch (void)
+		: node(nullptr)
+	{}
+
+	explicit Batch (std::vector<T>&& v)
+		: node(v.empty() ? nullptr : Ref<Node>::make(std::move(v)))
+	{}
+
+	size_t length (void) const
+	{
+		return node ? node->values.size() : 0;
+	}
+
+	explicit operator bool (void) const
+	{
+		return bool(node);
+	}
+
+	const T& operator [] (const size_t i) const
+	{
+		return node->values[i];
+	}
+
+	const T* begin (void) const
+	{
+		return node ? node->values.data() : nullptr;
+	}
+
+	const T* end (void) const
+	{
+		return begin() + length();
+	}
+};
+
+//out[i] = f(in[i]), a plain counted loop over restrict pointers the compiler can vectorise
+//when f is simple arithmetic
+template <typename T, typename R, typename F>
+void batchMap (const T* __restrict in, const size_t n, R* __restrict out, const F& f)
+{
+	for(size_t i = 0; i < n; i++)
+		out[i] = f(in[i]);
+}
+
+//reductions keep this many independent accumulators, a plain loop over an array of them 
+//vectorises without reassociating anything, so it works for floats without -ffast-math 
+//and the adds of neighbouring vectors don't wait on each other 
+constexpr int reduceLanes = 16;
+
+//the per lane accumulators are folded together at the end, so float sums can round 
+//differently from a left to right loop 
+template <typename T>
+T blockSum (const T* __restrict p, const size_t n)
+{
+	T acc[reduceLanes] = {};
+
+	size_t i = 0;
+	for(; i + reduceLanes <= n; i += reduceLanes)
+		for(int j = 0; j < reduceLanes; j++)
+			acc[j] += p[i + j];
+
+	for(; i < n; i++)
+		acc[0] += p[i];
+
+	T sum{};
+	for(int j = 0; j < reduceLanes; j++)
+		sum += acc[j];
+
+	return sum;
+}
+
+template <typename T, typename U>
+auto blockDot (const T* __restrict a, const U* __restrict b, const size_t n)
+{
+	using R = decltype(a[0] * b[0]);
+	R acc[reduceLanes] = {};
+
+	size_t i = 0;
+	for(; i + reduceLanes <= n; i += reduceLanes)
+		for(int j = 0; j < reduceLanes; j++)
+			acc[j] += a[i + j] * b[i + j];
+
+	for(; i < n; i++)
+		acc[0] += a[i] * b[i];
+
+	R sum{};
+	for(int j = 0; j < reduceLanes; j++)
+		sum += acc[j];
+
+	return sum;
+}
+
+//folds [p, p + n) into lo and hi, n can be 0
+template <typename T>
+void blockMinMax (const T* __restrict p, const size_t n, T& lo, T& hi)
+{
+	size_t i = 0;
+
+	if(n >= reduceLanes)
+	{
+		T mins[reduceLanes], maxs[reduceLanes];
+		for(int j = 0; j < reduceLanes; j++)
+			mins[j] = maxs[j] = lo;
+
+		for(; i + reduceLanes <= n; i += reduceLanes)
+			for(int j = 0; j < reduceLanes; j++)
+			{
+				mins[j] = p[i + j] < mins[j] ? p[i + j] : mins[j];
+				maxs[j] = maxs[j] < p[i + j] ? p[i + j] : maxs[j];
+			}
+
+		for(int j = 0; j < reduceLanes; j++)
+		{
+			lo = mins[j] < lo ? mins[j] : lo;
+			hi = hi < maxs[j] ? maxs[j] : hi;
+		}
+	}
+
+	for(; i < n; i++)
+	{
+		lo = p[i] < lo ? p[i] : lo;
+		hi = hi < p[i] ? p[i] : hi;
+	}
+}
+
+template <typename T, typename F>
+size_t blockCount (const T* __restrict p, const size_t n, const F& f)
+{
+	size_t acc[reduceLanes] = {};
+
+	size_t i = 0;
+	for(; i + reduceLanes <= n; i += reduceLanes)
+		for(int j = 0; j < reduceLanes; j++)
+			acc[j] += bool(f(p[i + j]));
+
+	for(; i < n; i++)
+		acc[0] += bool(f(p[i]));
+
+	size_t count = 0;
+	for(int j = 0; j < reduceLanes; j++)
+		count += acc[j];
+
+	return count;
+}
+
+#ifdef __AVX2__
+//for each 8 bit keep mask, the lanes to gather so the kept ones end up at the front
+constexpr auto compactTable = [](){
+	std::array<std::array<int32_t, 8>, 256> t{};
+
+	for(int mask = 0; mask < 256; mask++)
+	{
+		int k = 0;
+		for(int lane = 0; lane < 8; lane++)
+			if(mask >> lane & 1) t[mask][k++] = lane;
+	}
+
+	return t;
+}();
+#endif
+
+//copies the values of [in, in + n) that f keeps to the front of out, returns how many
+//out needs room for n values, values are copied without branching on f
+//and 4 byte ones go 8 at a time through an AVX2 shuffle when the target has it
+template <typename T, typename F>
+requires std::is_arithmetic_v<T>
+size_t batchFilter (const T* __restrict in, const size_t n, T* __restrict out, const F& f)
+{
+	size_t i = 0, k = 0;
+
+#ifdef __AVX2__
+	if constexpr (sizeof(T) == 4)
+	{
+		//the predicate runs as its own loop so it can vectorise too
+		std::vector<int32_t> keep(n);
+		for(size_t j = 0; j < n; j++)
+			keep[j] = -int32_t(bool(f(in[j])));
+
+		for(; i + 8 <= n; i += 8)
+		{
+			const __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keep.data() + i));
+			const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+			const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compactTable[mask].data()));
+
+			//k <= i, so all 8 lanes still land inside out
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_permutevar8x32_epi32(v, lanes));
+			k += __builtin_popcount(mask);
+		}
+
+		for(; i < n; i++)
+		{
+			out[k] = in[i];
+			k += keep[i] & 1;
+		}
+
+		return k;
+	}
+#endif
+
+	for(; i < n; i++)
+	{
+		out[k] = in[i];
+		k += bool(f(in[i]));
+	}
+
+	return k;
+}
+
+#endif
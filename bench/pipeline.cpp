@@ -0,0 +1,76 @@
+//g++ -std=c++20 -O2 bench/pipeline.cpp -o pipeline && ./pipeline [count]
+//Integers | Map | Filter | Take | Fold against the loop it stands for, and against
+//walking the same pipeline by hand with get and next, which is what Fold did before it pushed
+#include "../range.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+
+template <typename F>
+double time (F f)
+{
+	double best = 1e30;
+
+	for(int run = 0; run < 3; run++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		const std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+
+		best = std::min(best, took.count());
+	}
+
+	return best;
+}
+
+int main (const int argc, const char** argv)
+{
+	const int n = argc > 1 ? atoi(argv[1]) : 50000000;
+
+	const auto square = [](const int x){ return long(x) * x;};
+	const auto odd = [](const long x){ return bool(x & 1);};
+	const auto add = [](const long x, const long sum){ return sum + x;};
+
+	const auto pipeline = [&](){ return Integers(0) | Map(square) | Filter(odd) | Take(n);};
+
+	long pushed = 0, pulled = 0, looped = 0;
+
+	const double push = time([&](){ pushed = (pipeline() | Fold(add, 0L)).eval();});
+
+	const double pull = time([&]()
+	{
+		pulled = 0;
+
+		std::optional<decltype(pipeline())> s;
+		for(s.emplace(pipeline()); !s->end(); s.emplace(s->next()))
+			pulled += s->get();
+	});
+
+	const double loop = time([&]()
+	{
+		looped = 0;
+
+		int taken = 0;
+		for(int i = 0; taken < n; i++)
+		{
+			const long x = long(i) * i;
+			if(!(x & 1)) continue;
+
+			looped += x;
+			taken++;
+		}
+	});
+
+	if(pushed != looped || pulled != looped)
+	{
+		std::cout << "results differ " << pushed << " " << pulled << " " << looped << std::endl;
+		return 1;
+	}
+
+	std::cout << n << " values" << std::endl;
+	std::cout << "loop     " << loop << "s" << std::endl;
+	std::cout << "pipeline " << push << "s, " << push / loop << "x the loop" << std::endl;
+	std::cout << "pulled   " << pull << "s, " << pull / loop << "x the loop" << std::endl;
+}
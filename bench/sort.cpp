@@ -0,0 +1,57 @@
+//g++ -std=c++20 -O2 -pthread bench/sort.cpp -o sort && ./sort [threads] [elements]
+//times mergeSort on one list with a pool of 1, 2, 4 .. threads workers, 
+//and the sequential mergeSort as the baseline the speedups are against
+#include "../sort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+//best of a few runs, the first one also pays for faulting the memory in
+template <typename F>
+double time (F f)
+{
+	double best = 1e30;
+
+	for(int run = 0; run < 3; run++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		const std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+
+		best = std::min(best, took.count());
+	}
+
+	return best;
+}
+
+int main (const int argc, const char** argv)
+{
+	const int threads = argc > 1 ? atoi(argv[1]) : int(std::thread::hardware_concurrency());
+	const int n = argc > 2 ? atoi(argv[2]) : 4000000;
+
+	std::mt19937 gen(42);
+	ListBuilder<int> in;
+	for(int i = 0; i < n; i++) in.append(int(gen()));
+
+	const List<int> l = in.freeze();
+	const List<int> want = mergeSort(l);
+
+	const double base = time([&](){ mergeSort(l);});
+	std::cout << n << " elements, sequential " << base << "s" << std::endl;
+
+	for(int t = 1; t <= threads; t = t < threads && t * 2 > threads ? threads : t * 2)
+	{
+		Pool pool(t);
+
+		if(mergeSort(l, Parallel(pool)) != want)
+		{
+			std::cout << "wrong result with " << t << " threads" << std::endl;
+			return 1;
+		}
+
+		const double took = time([&](){ mergeSort(l, Parallel(pool));});
+		std::cout << t << " threads " << took << "s, " << base / took << "x" << std::endl;
+	}
+}
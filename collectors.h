@@ -1,15 +1,14 @@
 #pragma once
 #include "list.h"
-
-template <typename S>
-S evalHelper (const S stream)
-{
-	if(stream.end()) return stream;
-
-	stream.get();
-	return evalHelper( stream.next());
-}
-
+#include "vector.h"
+#include "tree.h"
+#include "hash.h"
+#include "generators.h"
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+#include <optional>
+#include <string>
 
 template<typename S>
 void eval (S stream)
@@ -19,63 +18,153 @@ void eval (S stream)
 					void, typename S::ValueType>::value, 
 			"requires stream with void value type");
 
-	evalHelper( stream);
+	pushAll(stream, [](){ return true;});
 }
 
 	
 
 
+//Node picks the layout of the collected list, void means the plain ListNode 
+template <typename Node = void>
 struct CollectList{}; 
 
-template<typename T, typename S>
+template <typename T, typename Node>
+using CollectedList = List<T, std::conditional_t<std::is_void_v<Node>, ListNode<T>, Node>>;
+
+template<typename T, typename S, typename Node = void>
 class CollectListInstance
 {
-	const List<T> res; 
+	using L = CollectedList<T, Node>;
 
-	List<T> streamBuild (const List<T> l , const S s)
+	const L res; 
+
+	//appends in stream order, so nothing needs reversing afterwards 
+	static L streamBuild (const S s)
 	{
-		if(s.end())
-			return l;
+		ListBuilder<T, typename L::NodeType> out;
+
+		pushAll(s, [&](const T& a){ out.append(a); return true;});
 
-		return  streamBuild(l.push(s.get()), s.next());
+		return out.freeze();
 	}
 
 	public:
 
-	List<T> get (void) const 
+	L get (void) const 
 	{
-		return res.reverse();
+		return res;
 	}
 
-	operator List<T> (void) const
+	operator L (void) const
 	{
-		return res.reverse();
+		return res;
 	}
 
 	CollectListInstance (const S s)
-		: res( streamBuild(List<T>(typename List<T>::SharedNode(nullptr)), s))
+		: res( streamBuild(s))
 	{
 	}
 };
 
 
+template<typename S, typename Node>
+CollectedList<typename S::ValueType, Node> operator | (S left, const CollectList<Node>& right)
+{
+	return CollectListInstance<typename S::ValueType, S, Node>(left);
+}
+
+//collects into whatever kind of list the container is, layout and allocator included 
+template <typename C> 
+requires requires { typename C::NodeType; }
+CollectList<typename C::NodeType> Collect (void) 
+{
+	return CollectList<typename C::NodeType>();
+}
+
+//collects into a standard container, reserving room first when the stream knows its size 
+template <typename C>
+struct CollectContainer{}; 
+
+using CollectString = CollectContainer<std::string>; 
+
+template <typename C> 
+requires requires (C c) { c.reserve(0); c.push_back(std::declval<typename C::value_type>()); }
+CollectContainer<C> Collect (void) 
+{
+	return CollectContainer<C>();
+}
+
+template<typename S, typename C>
+C operator | (S left, const CollectContainer<C>& right)
+{
+	C out;
+	out.reserve(sizeGuess(left));
+
+	pushAll(left, [&](const typename S::ValueType& a){ out.push_back(a); return true;});
+
+	return out;
+}
+
+struct CollectVector{}; 
+
 template<typename S>
-List<typename S::ValueType> operator | (S left, const CollectList& right)
+Vector<typename S::ValueType> operator | (S left, const CollectVector& right)
 {
-	return CollectListInstance<typename S::ValueType, S>(left);
+	VectorBuilder<typename S::ValueType> out;
+
+	pushAll(left, [&](const typename S::ValueType& a){ out.append(a); return true;});
+
+	return out.seal();
+}
+
+//sorted streams become a balanced tree in O(n), anything else is sorted first 
+//duplicates keep the first one seen, the same as pushing them one by one 
+struct CollectTree{};
+
+template<typename S>
+Tree<typename S::ValueType> operator | (S left, const CollectTree& right)
+{
+	using T = typename S::ValueType;
+
+	std::vector<T> in;
+	in.reserve(sizeGuess(left));
+	bool ordered = true;
+
+	pushAll(left, [&](const T& a){
+		if(!in.empty() && ordOverload(in.back(), a)) ordered = false;
+		in.push_back(a);
+		return true;
+	});
+
+	if(!ordered)
+		std::stable_sort(in.begin(), in.end(), [](const T& a, const T& b){ return ordOverload(b, a);});
+
+	return Tree<T>(FromSorted(), in);
 }
 
-//SFINAE to detect if we're collecting a list or what 
-template <typename T, 
-		  typename = std::enable_if< 
-		std::is_same<
-					typename List<T>::DataType, T
-					>::value
-									>
-		>
-CollectList Collect (void) 
+//a stream of values into a HashSet, built in place 
+struct CollectHashSet{};
+
+template<typename S>
+HashSet<typename S::ValueType> operator | (S left, const CollectHashSet& right)
 {
-	return CollectList();
+	HashSetBuilder<typename S::ValueType> out;
+
+	pushAll(left, [&](const typename S::ValueType& a){ out.push(a); return true;});
+
+	return out.freeze();
 }
 
+//a stream of key value pairs into a HashMap, later pairs win 
+struct CollectHashMap{};
 
+template<typename S>
+auto operator | (S left, const CollectHashMap& right) 
+	-> HashMap<typename S::ValueType::first_type, typename S::ValueType::second_type>
+{
+	HashMapBuilder<typename S::ValueType::first_type, typename S::ValueType::second_type> out;
+
+	pushAll(left, [&](const typename S::ValueType& a){ out.set(a.first, a.second); return true;});
+
+	return out.freeze();
+}
@@ -2,6 +2,8 @@
 #include "list.h" 
 #include "string.h"
 #include "tree.h"
+#include "vector.h"
+#include "hash.h"
 #include <iterator>
 #include <optional>
 #include <random>
@@ -9,6 +11,8 @@
 #include <stdio.h>
 #include <iostream>
 #include <concepts>
+#include <type_traits>
+#include <span>
 
 template <typename T>
 class FunStream
@@ -43,13 +47,128 @@ concept IsFunStream = requires(T s)
 
 
 
+struct SizeHint;
+
+//streams that can be cut in two, so Reduce can work on both halves at once 
+//split gives a first half and the rest, which between them hold the same values in the same order 
+//and sizeHint says how many are left, so the cutting knows when to stop 
 template <typename T>
+concept IsSplittable = requires(const T s)
+{
+	{s.split()} -> std::same_as<std::pair<T, T>>;
+	{s.sizeHint()} -> std::same_as<std::optional<SizeHint>>;
+};
+
+//push protocol, the fast path terminals use to run a whole pipeline 
+//a stream that has push hands each of its values to sink(value) from one loop of its own 
+//with plain mutable cursors, and stops as soon as sink returns false 
+//push returns true when the stream ran out by itself rather than being stopped 
+//
+//adapters forward push by wrapping the sink, so a chain of them inlines into one loop 
+//void streams call sink() with no value, and anything without push is pulled by pushAll 
+template <typename S, typename Sink>
+concept HasPush = requires(const S s, Sink& sink)
+{
+	{s.push(sink)} -> std::same_as<bool>;
+};
+
+template <typename S, typename Sink>
+bool pushAll (const S& stream, Sink&& sink)
+{
+	if constexpr (HasPush<S, std::remove_reference_t<Sink>>)
+		return stream.push(sink);
+	else
+	{
+		std::optional<S> s(stream);
+		for(; !s->end(); s.emplace(s->next()))
+		{
+			if constexpr (std::is_void_v<typename S::ValueType>)
+			{
+				s->get();
+				if(!sink()) return false;
+			}
+			else if(!sink(s->get())) 
+				return false;
+		}
+
+		return true;
+	}
+}
+
+//contiguous blocks, for streams whose values already sit next to each other in memory 
+//blocks hands each run to block(pointer, count) instead of one value at a time, so reductions 
+//can use wide kernels, and stops as soon as block returns false, the same way push does 
+template <typename S>
+concept HasBlocks = requires(const S s)
+{
+	{s.blocks([](const typename S::ValueType*, size_t){ return true;})} -> std::same_as<bool>;
+};
+
+//runs block over contiguous runs when the stream has them and one over single values otherwise 
+template <typename S, typename Block, typename One>
+bool pushBlocks (const S& stream, Block&& block, One&& one)
+{
+	if constexpr (HasBlocks<S>)
+		return stream.blocks(block);
+	else
+		return pushAll(stream, one);
+}
+
+//how many values a stream has left, exactly or at most, for streams that can tell without walking 
+//sources that know say so, adapters work theirs out from upstream, and sizeHint is empty for the rest 
+struct SizeHint 
+{
+	size_t size; 
+	bool exact; 
+};
+
+template <typename S>
+concept HasSizeHint = requires(const S s)
+{
+	{s.sizeHint()} -> std::same_as<std::optional<SizeHint>>;
+};
+
+template <typename S>
+std::optional<SizeHint> sizeHint (const S& s)
+{
+	if constexpr (HasSizeHint<S>)
+		return s.sizeHint();
+	else
+		return std::nullopt;
+}
+
+//enough room for everything if the hint is any good, collectors reserve this much 
+template <typename S>
+size_t sizeGuess (const S& s)
+{
+	const auto hint = sizeHint(s);
+	return hint ? hint->size : 0;
+}
+
+template <typename T, typename Node = ListNode<T>>
 class ListStream 
 {
-	const List<T> res; 
+	const List<T, Node> res; 
+	const int count; //how much of res to read, less than all of it after a split
+
+	ListStream (const List<T, Node> l, const int n)
+		: res(l), count(n)
+	{}
 
 	public:
 	using ValueType = T;
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		if(!count) return true;
+
+		int left = count;
+		bool done = true;
+		res.walk([&](const T& a){ done = sink(a); return done && --left > 0;});
+
+		return done;
+	}
 	T get (void) const
 	{ 
 		return res.peek();
@@ -57,16 +176,244 @@ class ListStream
 
 	bool end (void) const
 	{
-		return !res.length();
+		return !count;
+	}
+
+	ListStream  next (void) const
+	{
+		return ListStream(res.pop(), count - 1);
 	}
 
-	ListStream<T>  next (void) const
+	std::optional<SizeHint> sizeHint (void) const
 	{
-		return ListStream<T>(res.pop());
+		return SizeHint{size_t(count), true};
 	}
 
-	ListStream (List<T> l)
-		:res(l)
+	//walks to the middle, so splitting is O(n) 
+	std::pair<ListStream, ListStream> split (void) const
+	{
+		const int half = count / 2;
+
+		List<T, Node> rest = res;
+		for(int i = 0; i < half; i++) rest = rest.pop();
+
+		return {ListStream(res, half), ListStream(rest, count - half)};
+	}
+
+	ListStream (List<T, Node> l)
+		:res(l), count(l.length())
+	{}
+};
+
+//walks a Vector a block at a time, so each step is O(1) instead of a trie lookup 
+template <typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class VectorStream 
+{
+	using V = Vector<T, Alloc, Count>;
+
+	const V res; 
+	const int i;
+	const typename V::Link leaf;
+
+	VectorStream (const V v, const int p, const typename V::Link l)
+		: res(v), i(p), leaf(l)
+	{}
+
+	public:
+	using ValueType = T;
+	T get (void) const
+	{ 
+		return *leaf->value(i & V::Node::mask);
+	}
+
+	bool end (void) const
+	{
+		return i >= res.length();
+	}
+
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		return SizeHint{size_t(i < res.length() ? res.length() - i : 0), true};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		for(int n = i; n < res.length(); n = (n | V::Node::mask) + 1)
+		{
+			const typename V::Link block = n == i ? leaf : res.leaf(n);
+
+			for(int j = n & V::Node::mask; j < block->size; j++)
+				if(!sink(*block->value(j))) return false;
+		}
+
+		return true;
+	}
+
+	//every leaf is a block of up to 32 values 
+	template <typename Block>
+	bool blocks (Block&& block) const
+	{
+		for(int n = i; n < res.length(); n = (n | V::Node::mask) + 1)
+		{
+			const typename V::Link b = n == i ? leaf : res.leaf(n);
+			const int from = n & V::Node::mask;
+
+			if(!block(b->value(from), size_t(b->size - from))) return false;
+		}
+
+		return true;
+	}
+
+	VectorStream  next (void) const
+	{
+		const int n = i + 1;
+
+		if((n & V::Node::mask) && n < res.length())
+			return VectorStream(res, n, leaf);
+
+		return VectorStream(res, n, n < res.length() ? res.leaf(n) : nullptr);
+	}
+
+	VectorStream (const V v)
+		: res(v), i(0), leaf(v.length() ? v.leaf(0) : nullptr)
+	{}
+};
+
+//in order walk of a Tree, the cursor is a persistent stack of the ancestors still to visit 
+//so copies of the stream share it, and next is O(1) amortised and O(log n) at worst 
+//Reverse walks from the largest element down 
+template <typename T, Ord<T> Compare = ordOverload, typename Alloc = HeapAlloc, typename Count = DefaultCount, bool Reverse = false>
+class TreeStream 
+{
+	using Tr = Tree<T, Compare, Alloc, Count>;
+	using Node = typename Tr::Node;
+
+	const Tr tree; //keeps the nodes on the path alive
+	const List<const Node*> path;
+
+	//n and the spine below it towards the first element to visit
+	static List<const Node*> descend (const Node* n, List<const Node*> p)
+	{
+		for(; n; n = (Reverse ? n->right : n->left).get())
+			p = p.push(n);
+
+		return p;
+	}
+
+	TreeStream (const Tr t, const List<const Node*> p)
+		: tree(t), path(p)
+	{}
+
+	public:
+	using ValueType = T;
+	T get (void) const
+	{ 
+		return path.peek()->res;
+	}
+
+	bool end (void) const
+	{
+		return !path.length();
+	}
+
+	TreeStream  next (void) const
+	{
+		const Node* n = path.peek();
+		return TreeStream(tree, descend((Reverse ? n->left : n->right).get(), path.pop()));
+	}
+
+	//the values still to come as a tree of their own, O(log n)
+	Tr rest (void) const
+	{
+		if(end()) return Tr();
+
+		const int k = tree.rank(get());
+		return Reverse ? tree.splitAt(k + 1).first : tree.splitAt(k).second;
+	}
+
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		if(end()) return SizeHint{0, true};
+
+		const int k = tree.rank(get());
+		return SizeHint{size_t(Reverse ? k + 1 : tree.size() - k), true};
+	}
+
+	//cuts what is left of the tree in half with splitAt, O(log n)
+	std::pair<TreeStream, TreeStream> split (void) const
+	{
+		const Tr left = rest();
+		const auto [low, high] = left.splitAt(left.size() / 2);
+
+		if(Reverse) return {TreeStream(high), TreeStream(low)};
+
+		return {TreeStream(low), TreeStream(high)};
+	}
+
+	TreeStream (const Tr t)
+		: tree(t), path(descend(t.head.get(), List<const Node*>()))
+	{}
+};
+
+//walks every entry in trie order, entries of a node before its children
+//the cursor is a persistent stack of nodes and positions, so copies of the stream share it
+template <typename E, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class HashStream
+{
+	using Node = HashNode<E, Alloc, Count>;
+	using Frame = std::pair<const Node*, size_t>;
+
+	const typename Node::Link root; //keeps the nodes on the path alive
+	const List<Frame> path;
+
+	//moves the top of p onto the next entry, descending into children on the way
+	static List<Frame> settle (List<Frame> p)
+	{
+		while(p.length())
+		{
+			const auto [n, i] = p.peek();
+
+			if(i < n->entries().size())
+				return p;
+
+			p = p.pop();
+
+			const size_t c = i - n->entries().size();
+			if(c < n->children().size())
+				p = p.push(Frame(n, i + 1)).push(Frame(n->child(c)->get(), 0));
+		}
+
+		return p;
+	}
+
+	HashStream (const typename Node::Link r, const List<Frame> p)
+		: root(r), path(p)
+	{}
+
+	public:
+	using ValueType = E;
+	E get (void) const
+	{
+		const auto [n, i] = path.peek();
+		return *n->entry(i);
+	}
+
+	bool end (void) const
+	{
+		return !path.length();
+	}
+
+	HashStream next (void) const
+	{
+		const auto [n, i] = path.peek();
+		return HashStream(root, settle(path.pop().push(Frame(n, i + 1))));
+	}
+
+	//works for HashMap and HashSet alike
+	template <typename M>
+	explicit HashStream (const M m)
+		: root(m.root), path(settle(m.root ? List<Frame>(Frame(m.root.get(), 0)) : List<Frame>()))
 	{}
 };
 
@@ -95,7 +442,7 @@ ListStream<String> FileLineStream (const String name)
 }
 	
 
-template <typename IT, typename T = IT>
+template <typename IT, typename T = typename std::iterator_traits<IT>::value_type>
 class IteratorStream : public FunStream<IteratorStream<IT, T>>
 {
 	const IT first, last;
@@ -104,7 +451,7 @@ class IteratorStream : public FunStream<IteratorStream<IT, T>>
 
 	T get_ (void) const 
 	{
-		return first; 
+		return *first; 
 	}
 
 	bool end_ (void) const 
@@ -117,6 +464,44 @@ class IteratorStream : public FunStream<IteratorStream<IT, T>>
 		return IteratorStream( first + 1, last);
 	}
 
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		return SizeHint{size_t(first < last ? std::distance(first, last) : 0), true};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		for(IT i = first; i < last; ++i)
+			if(!sink(T(*i))) return false;
+
+		return true;
+	}
+
+	std::pair<IteratorStream, IteratorStream> split (void) const
+	requires std::random_access_iterator<IT>
+	{
+		const IT mid = first < last ? first + (last - first) / 2 : first;
+		return {IteratorStream(first, mid), IteratorStream(mid, last)};
+	}
+
+	//a vector or array is one block 
+	std::span<const T> span (void) const
+	requires std::contiguous_iterator<IT> && std::same_as<std::iter_value_t<IT>, T>
+	{
+		if(first >= last) return {};
+
+		return std::span<const T>(std::to_address(first), size_t(last - first));
+	}
+
+	template <typename Block>
+	requires std::contiguous_iterator<IT> && std::same_as<std::iter_value_t<IT>, T>
+	bool blocks (Block&& block) const
+	{
+		const std::span<const T> all = span();
+		return all.empty() || block(all.data(), all.size());
+	}
+
 	using ValueType = T; 
 
 	IteratorStream (const IT b, const IT e)
@@ -161,6 +546,44 @@ class Integers
 		return Integers( i + 1, last , repEnded);
 	}
 
+	std::pair<Integers, Integers> split (void) const
+	{
+		if(ended || i == last) return {*this, Integers(0, 0, true)};
+
+		const int step = i > last ? -1 : 1;
+		const long long half = (std::abs((long long)last - i) + 1) / 2;
+
+		return {Integers(i, i + step * (half - 1)), Integers(i + step * half, last)};
+	}
+
+	//the first and last values still to come, reductions use it for closed forms
+	std::optional<std::pair<int, int>> bounds (void) const
+	{
+		if(ended) return std::nullopt;
+
+		return std::pair(i, last);
+	}
+
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		if(ended) return SizeHint{0, true};
+
+		return SizeHint{size_t(i > last ? (long long)i - last : (long long)last - i) + 1, true};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		if(ended) return true;
+
+		const int step = i > last ? -1 : 1;
+		for(int n = i;; n += step)
+		{
+			if(!sink(n)) return false;
+			if(n == last) return true;
+		}
+	}
+
 
 
 	friend bool operator == (const Integers &a, const Integers &b)
@@ -243,14 +666,46 @@ class UniformDist
 	}
 };
 
-template <typename T> 
-auto Range ( const List<T> l) -> ListStream<T>
+template <typename T, typename Node> 
+auto Range ( const List<T, Node> l) -> ListStream<T, Node>
+{
+	return ListStream<T, Node>(l);
+}
+
+template <typename T, typename Alloc, typename Count> 
+auto Range ( const Vector<T, Alloc, Count> v) -> VectorStream<T, Alloc, Count>
+{
+	return VectorStream<T, Alloc, Count>(v);
+}
+
+template <typename T, Ord<T> Compare, typename Alloc, typename Count> 
+auto Range ( const Tree<T, Compare, Alloc, Count> t) -> TreeStream<T, Compare, Alloc, Count>
+{
+	return TreeStream<T, Compare, Alloc, Count>(t);
+}
+
+//largest element first
+template <typename T, Ord<T> Compare, typename Alloc, typename Count> 
+auto ReverseRange ( const Tree<T, Compare, Alloc, Count> t) -> TreeStream<T, Compare, Alloc, Count, true>
+{
+	return TreeStream<T, Compare, Alloc, Count, true>(t);
+}
+
+template <typename K, typename V, typename Hash, typename Alloc, typename Count> 
+auto Range ( const HashMap<K, V, Hash, Alloc, Count> m) -> HashStream<std::pair<K, V>, Alloc, Count>
+{
+	return HashStream<std::pair<K, V>, Alloc, Count>(m);
+}
+
+template <typename T, typename Hash, typename Alloc, typename Count> 
+auto Range ( const HashSet<T, Hash, Alloc, Count> s) -> HashStream<T, Alloc, Count>
 {
-	return ListStream<T>(l);
+	return HashStream<T, Alloc, Count>(s);
 }
 
+//the stream reads the container in place, so it has to outlive the stream 
 template <typename T, typename IT = typename T::const_iterator>
-auto Range (const T container) -> IteratorStream<IT> 
+auto Range (const T& container) -> IteratorStream<IT> 
 {
 	return IteratorStream<IT>(container.begin(), container.end());
 }
@@ -258,36 +713,47 @@ auto Range (const T container) -> IteratorStream<IT>
 struct LazyFileStream
 {
 	using ValueType = char; 
-	struct CharList
+	struct CharList : public Counted<>
 	{
 		const char res;
-		mutable std::shared_ptr<CharList> tail;
-		mutable std::shared_ptr<CharList> head;
+		mutable Ref<CharList> tail;
 
-		CharList (const char c, const std::shared_ptr<CharList> t)
+		CharList (const char c, const Ref<CharList> t)
 			: res(c), tail(t)
 		{}
 
+		//long files make long chains, unlink them one at a time instead of recursing 
+		~CharList (void)
+		{
+			Ref<CharList> n = std::move(tail);
+
+			while(n.unique())
+			{
+				Ref<CharList> t = std::move(n->tail);
+				n = std::move(t);
+			}
+		}
+
 		void push (const char c) const
 		{
 			if(!tail)
 			{
-				tail = std::make_shared<CharList>(c, nullptr);
+				tail = Ref<CharList>::make(c, nullptr);
 				return; 
 			}
 
 			auto i = tail;
 			while(i->tail) i = i->tail;
 
-			i->tail = std::make_shared<CharList>(c, nullptr);
+			i->tail = Ref<CharList>::make(c, nullptr);
 			return;
 		}
 	};
 
-	const std::shared_ptr<CharList> res; 
+	const Ref<CharList> res; 
 	FILE* const file;
 
-	LazyFileStream (const std::shared_ptr<CharList> c, FILE* f)
+	LazyFileStream (const Ref<CharList> c, FILE* f)
 		: res(c), file(f)
 	{}
 
@@ -319,15 +785,15 @@ struct LazyFileStream
 LazyFileStream fileStream (const char* name)
 {
 		FILE* const file = fopen(name, "r");
-		if(!file) return LazyFileStream( std::make_shared<LazyFileStream::CharList>(EOF, nullptr), file);
-		return LazyFileStream( std::make_shared<LazyFileStream::CharList>(fgetc(file), nullptr), file);
+		if(!file) return LazyFileStream( Ref<LazyFileStream::CharList>::make(EOF, nullptr), file);
+		return LazyFileStream( Ref<LazyFileStream::CharList>::make(fgetc(file), nullptr), file);
 }
 
 
 LazyFileStream fileStream (FILE* f)
 {
-		if(!f) return LazyFileStream( std::make_shared<LazyFileStream::CharList>(EOF, nullptr), f);
-		return LazyFileStream( std::make_shared<LazyFileStream::CharList>(fgetc(f), nullptr), f);
+		if(!f) return LazyFileStream( Ref<LazyFileStream::CharList>::make(EOF, nullptr), f);
+		return LazyFileStream( Ref<LazyFileStream::CharList>::make(fgetc(f), nullptr), f);
 }
 
 
@@ -0,0 +1,836 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include "list.h"
+#include "ref.h"
+
+//persistent hash array mapped trie, every node splits on 5 more bits of the hash
+//a node keeps its entries and its children in two packed arrays in its own allocation, a bitmap for each says
+//which of the 32 slots are in use and a popcount of the bits below finds where a slot lives
+//lookups follow at most 13 links for a 64 bit hash, updates copy that path and share the rest
+//
+//keys whose whole hash is the same end up together in a collision node that is searched in order
+
+//what the trie stores and how to get the key back out of it
+template <typename K, typename V>
+struct MapEntry
+{
+	using Key = K;
+	using Entry = std::pair<K, V>;
+
+	static const K& key (const Entry& e)
+	{
+		return e.first;
+	}
+};
+
+template <typename T>
+struct SetEntry
+{
+	using Key = T;
+	using Entry = T;
+
+	static const T& key (const Entry& e)
+	{
+		return e;
+	}
+};
+
+//a packed array read as if slot drop had been taken out of it and value put in at add,
+//either can be left at -1, it is how a node is made from the one it replaces without copying twice
+//with take set the old slots are moved out, for when the old node is about to go
+template <typename V>
+struct Splice
+{
+	V* from = nullptr;
+	int n = 0;
+	int drop = -1;
+	int add = -1;
+	const V* value = nullptr;
+	bool take = false;
+
+	int size (void) const
+	{
+		return n - (drop >= 0) + (add >= 0);
+	}
+
+	//makes slot j of the result at p
+	void build (V* const p, const int j) const
+	{
+		if(j == add)
+		{
+			new (p) V(*value);
+			return;
+		}
+
+		const int k = add >= 0 && j > add ? j - 1 : j;
+		V& a = from[drop >= 0 && k >= drop ? k + 1 : k];
+
+		if(take) new (p) V(std::move(a));
+		else     new (p) V(a);
+	}
+};
+
+//the entries and then the children live right after the node in the same allocation through Alloc,
+//sized by the maps, so a node is one allocation
+//
+//a node that is shared has exactly as many slots as it uses and changing their number makes a new one,
+//a node a builder alone holds gets room to spare like a vector, and fills it in place
+template <typename E, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+struct alignas(alignof(E) > alignof(void*) ? alignof(E) : alignof(void*)) HashNode : public Counted<Count, Alloc>
+{
+	using Link = Ref<HashNode>;
+
+	uint32_t dataMap; //slots holding an entry
+	uint32_t nodeMap; //slots holding a child
+	const bool collision; //below the last level, entries share a hash and the maps are unused
+	int entryCount;
+	int childCount;
+	const int entryRoom;
+	const int childRoom;
+
+	HashNode (const uint32_t d, const uint32_t m, const bool c, const Splice<E>& es, const Splice<Link>& cs, const int er, const int cr)
+		: dataMap(d), nodeMap(m), collision(c), entryCount(0), childCount(0), entryRoom(er), childRoom(cr)
+	{
+		try
+		{
+			for(; entryCount < es.size(); entryCount++) es.build(entry(entryCount), entryCount);
+			for(; childCount < cs.size(); childCount++) cs.build(child(childCount), childCount);
+		}
+		catch (...)
+		{
+			while(childCount) child(--childCount)->~Link();
+			while(entryCount) entry(--entryCount)->~E();
+			throw;
+		}
+	}
+
+	HashNode (const HashNode&) = delete;
+
+	~HashNode (void)
+	{
+		for(int i = 0; i < childCount; i++) child(i)->~Link();
+		for(int i = 0; i < entryCount; i++) entry(i)->~E();
+	}
+
+	//the children come after the entries, rounded up to where a Link may start
+	static size_t childOffset (const int entries)
+	{
+		const size_t end = sizeof(HashNode) + entries * sizeof(E);
+		return (end + alignof(Link) - 1) & ~(alignof(Link) - 1);
+	}
+
+	static size_t sizeFor (const int entries, const int children)
+	{
+		return childOffset(entries) + children * sizeof(Link);
+	}
+
+	size_t bytes (void) const
+	{
+		return sizeFor(entryRoom, childRoom);
+	}
+
+	E* entry (const int i) const
+	{
+		unsigned char* const base = reinterpret_cast<unsigned char*>(const_cast<HashNode*>(this));
+		return std::launder(reinterpret_cast<E*>(base + sizeof(HashNode))) + i;
+	}
+
+	Link* child (const int i) const
+	{
+		unsigned char* const base = reinterpret_cast<unsigned char*>(const_cast<HashNode*>(this));
+		return std::launder(reinterpret_cast<Link*>(base + childOffset(entryRoom))) + i;
+	}
+
+	std::span<E> entries (void) const
+	{
+		return std::span<E>(entry(0), entryCount);
+	}
+
+	std::span<Link> children (void) const
+	{
+		return std::span<Link>(child(0), childCount);
+	}
+
+	//puts a in at j of the n slots at p, there has to be room for one more
+	template <typename V>
+	static void open (V* const p, const int n, const int j, const V& a)
+	{
+		if(j == n)
+		{
+			new (p + n) V(a);
+			return;
+		}
+
+		new (p + n) V(std::move(p[n - 1]));
+		std::move_backward(p + j, p + n - 1, p + n);
+		p[j] = a;
+	}
+
+	//takes slot j out of the n slots at p
+	template <typename V>
+	static void close (V* const p, const int n, const int j)
+	{
+		std::move(p + j + 1, p + n, p + j);
+		p[n - 1].~V();
+	}
+
+	void addEntry (const int j, const E& e)
+	{
+		open(entry(0), entryCount, j, e);
+		entryCount++;
+	}
+
+	void addChild (const int j, const Link& c)
+	{
+		open(child(0), childCount, j, c);
+		childCount++;
+	}
+
+	void dropEntry (const int j)
+	{
+		close(entry(0), entryCount, j);
+		entryCount--;
+	}
+
+	void dropChild (const int j)
+	{
+		close(child(0), childCount, j);
+		childCount--;
+	}
+};
+
+//the trie itself, shared by HashMap and HashSet which only differ in what an entry is
+template <typename Traits, typename Hash, typename Alloc, typename Count>
+struct HashTrie
+{
+	using Key = typename Traits::Key;
+	using Entry = typename Traits::Entry;
+	using Node = HashNode<Entry, Alloc, Count>;
+	using Link = typename Node::Link;
+
+	static constexpr int bits = 5;
+	static constexpr int hashBits = 64;
+
+	static uint64_t hash (const Key& k)
+	{
+		return Hash()(k);
+	}
+
+	static uint32_t bitFor (const uint64_t h, const int shift)
+	{
+		return uint32_t(1) << ((h >> shift) & 31);
+	}
+
+	//where slot bit lives in a packed array described by map
+	static int index (const uint32_t map, const uint32_t bit)
+	{
+		return std::popcount(map & (bit - 1));
+	}
+
+	static int roomFor (const int n)
+	{
+		return n ? int(std::bit_ceil(unsigned(n))) : 0;
+	}
+
+	static Link make (const uint32_t dataMap, const uint32_t nodeMap, const bool collision, const Splice<Entry>& es, const Splice<Link>& cs, const int er, const int cr)
+	{
+		return Link::makeSized(Node::sizeFor(er, cr), dataMap, nodeMap, collision, es, cs, er, cr);
+	}
+
+	//a node with grow set is one a builder will keep writing to, so it is given spare room
+	static Link make (const uint32_t dataMap, const uint32_t nodeMap, const bool collision, const Splice<Entry>& es, const Splice<Link>& cs, const bool grow = false)
+	{
+		const int er = grow ? roomFor(es.size()) : es.size();
+		const int cr = grow ? roomFor(cs.size()) : cs.size();
+
+		return make(dataMap, nodeMap, collision, es, cs, er, cr);
+	}
+
+	//n's own slots, moved out of it when we are the only one holding it
+	static Splice<Entry> entriesOf (const Link& n, const int drop = -1, const int add = -1, const Entry* value = nullptr)
+	{
+		return {n->entry(0), n->entryCount, drop, add, value, n.unique()};
+	}
+
+	static Splice<Link> childrenOf (const Link& n, const int drop = -1, const int add = -1, const Link* value = nullptr)
+	{
+		return {n->child(0), n->childCount, drop, add, value, n.unique()};
+	}
+
+	//makes n safe to write to, the trick that lets one insert serve both
+	//persistent updates and builders, see TreeBuilder
+	static Node* own (Link& n)
+	{
+		if(!n.unique())
+			n = make(n->dataMap, n->nodeMap, n->collision, entriesOf(n), childrenOf(n));
+
+		return n.get();
+	}
+
+	//n with e put in at entry slot j, in place when n is ours and has room
+	static Link withEntry (Link n, const uint32_t dataMap, const int j, const Entry& e)
+	{
+		if(n.unique() && n->entryCount < n->entryRoom)
+		{
+			n->addEntry(j, e);
+			n->dataMap = dataMap;
+			return n;
+		}
+
+		return make(dataMap, n->nodeMap, n->collision, entriesOf(n, -1, j, &e), childrenOf(n), n.unique());
+	}
+
+	static const Entry* find (const Node* n, const Key& k, const uint64_t h)
+	{
+		for(int shift = 0; n; shift += bits)
+		{
+			if(n->collision)
+			{
+				for(const Entry& e : n->entries())
+					if(Traits::key(e) == k) return &e;
+
+				return nullptr;
+			}
+
+			const uint32_t bit = bitFor(h, shift);
+
+			if(n->dataMap & bit)
+			{
+				const Entry& e = *n->entry(index(n->dataMap, bit));
+				return Traits::key(e) == k ? &e : nullptr;
+			}
+
+			if(!(n->nodeMap & bit))
+				return nullptr;
+
+			n = n->child(index(n->nodeMap, bit))->get();
+		}
+
+		return nullptr;
+	}
+
+	//a node holding just a and b, which differ somewhere at or below shift
+	static Link pair (const Entry& a, const uint64_t ha, const Entry& b, const uint64_t hb, const int shift)
+	{
+		if(shift >= hashBits)
+		{
+			Link n = make(0, 0, true, {nullptr, 0, -1, 0, &a}, {}, 2, 0);
+			n->addEntry(1, b);
+			return n;
+		}
+
+		const uint32_t ba = bitFor(ha, shift);
+		const uint32_t bb = bitFor(hb, shift);
+
+		if(ba == bb)
+		{
+			const Link c = pair(a, ha, b, hb, shift + bits);
+			return make(0, ba, false, {}, {nullptr, 0, -1, 0, &c});
+		}
+
+		Link n = make(ba | bb, 0, false, {nullptr, 0, -1, 0, ba < bb ? &a : &b}, {}, 2, 0);
+		n->addEntry(1, ba < bb ? b : a);
+		return n;
+	}
+
+	//n with e added, or with an old entry for the same key replaced when replace is set
+	//n itself comes back when there was nothing to do, otherwise added counts new keys
+	static Link insert (Link n, const Entry& e, const uint64_t h, const int shift, const bool replace, int& added)
+	{
+		if(!n)
+		{
+			added++;
+			return make(bitFor(h, shift), 0, false, {nullptr, 0, -1, 0, &e}, {});
+		}
+
+		if(n->collision)
+		{
+			for(int i = 0; i < n->entryCount; i++)
+			{
+				if(Traits::key(*n->entry(i)) == Traits::key(e))
+				{
+					if(replace) *own(n)->entry(i) = e;
+					return n;
+				}
+			}
+
+			const int j = n->entryCount;
+
+			added++;
+			return withEntry(std::move(n), 0, j, e);
+		}
+
+		const uint32_t bit = bitFor(h, shift);
+
+		if(n->nodeMap & bit)
+		{
+			const int i = index(n->nodeMap, bit);
+
+			//a node only we hold is updated where it is, so its child may be too
+			if(n.unique())
+			{
+				*n->child(i) = insert(std::move(*n->child(i)), e, h, shift + bits, replace, added);
+				return n;
+			}
+
+			Link c = insert(*n->child(i), e, h, shift + bits, replace, added);
+			if(c == *n->child(i)) return n;
+
+			*own(n)->child(i) = std::move(c);
+			return n;
+		}
+
+		if(n->dataMap & bit)
+		{
+			const int i = index(n->dataMap, bit);
+			const Entry& old = *n->entry(i);
+
+			if(Traits::key(old) == Traits::key(e))
+			{
+				if(replace) *own(n)->entry(i) = e;
+				return n;
+			}
+
+			//two keys want the slot, they move down a level together
+			const Link c = pair(old, hash(Traits::key(old)), e, h, shift + bits);
+			const uint32_t nodeMap = n->nodeMap | bit;
+			const int j = index(nodeMap, bit);
+
+			added++;
+
+			if(n.unique() && n->childCount < n->childRoom)
+			{
+				n->dropEntry(i);
+				n->addChild(j, c);
+				n->dataMap ^= bit;
+				n->nodeMap = nodeMap;
+				return n;
+			}
+
+			return make(n->dataMap ^ bit, nodeMap, false, entriesOf(n, i), childrenOf(n, -1, j, &c), n.unique());
+		}
+
+		const uint32_t dataMap = n->dataMap | bit;
+		const int j = index(n->dataMap, bit);
+
+		added++;
+		return withEntry(std::move(n), dataMap, j, e);
+	}
+
+	//n with the child in slot bit changed to c, pulled up into n when it is down to one entry
+	//and nothing at all when that leaves n empty
+	static Link settle (Link n, const uint32_t bit, const int i, const Link& c)
+	{
+		if(c && (c->entryCount != 1 || c->childCount))
+		{
+			*own(n)->child(i) = c;
+			return n;
+		}
+
+		if(!c && n->entryCount + n->childCount == 1)
+			return nullptr;
+
+		if(!n.unique())
+		{
+			if(!c) return make(n->dataMap, n->nodeMap ^ bit, false, entriesOf(n), childrenOf(n, i));
+
+			return make(n->dataMap | bit, n->nodeMap ^ bit, false
+				, entriesOf(n, -1, index(n->dataMap, bit), c->entry(0)), childrenOf(n, i));
+		}
+
+		n->dropChild(i);
+		n->nodeMap ^= bit;
+
+		if(!c) return n;
+
+		const uint32_t dataMap = n->dataMap | bit;
+		const int j = index(n->dataMap, bit);
+
+		return withEntry(std::move(n), dataMap, j, *c->entry(0));
+	}
+
+	//n without entry slot i, or nothing when that was all it held
+	static Link withoutEntry (Link n, const uint32_t dataMap, const int i)
+	{
+		if(n->entryCount + n->childCount == 1)
+			return nullptr;
+
+		if(n.unique())
+		{
+			n->dropEntry(i);
+			n->dataMap = dataMap;
+			return n;
+		}
+
+		return make(dataMap, n->nodeMap, n->collision, entriesOf(n, i), childrenOf(n));
+	}
+
+	//n without k, or n itself when k was never there
+	static Link erase (Link n, const Key& k, const uint64_t h, const int shift, int& removed)
+	{
+		if(!n)
+			return n;
+
+		if(n->collision)
+		{
+			for(int i = 0; i < n->entryCount; i++)
+			{
+				if(Traits::key(*n->entry(i)) == k)
+				{
+					removed++;
+					return withoutEntry(std::move(n), 0, i);
+				}
+			}
+
+			return n;
+		}
+
+		const uint32_t bit = bitFor(h, shift);
+
+		if(n->dataMap & bit)
+		{
+			const int i = index(n->dataMap, bit);
+			if(!(Traits::key(*n->entry(i)) == k)) return n;
+
+			const uint32_t dataMap = n->dataMap ^ bit;
+
+			removed++;
+			return withoutEntry(std::move(n), dataMap, i);
+		}
+
+		if(!(n->nodeMap & bit))
+			return n;
+
+		const int i = index(n->nodeMap, bit);
+
+		if(n.unique())
+		{
+			const Link c = erase(std::move(*n->child(i)), k, h, shift + bits, removed);
+			return settle(std::move(n), bit, i, c);
+		}
+
+		const Link c = erase(*n->child(i), k, h, shift + bits, removed);
+		if(c == *n->child(i)) return n;
+
+		return settle(std::move(n), bit, i, c);
+	}
+};
+
+template <typename K, typename V, typename Hash, typename Alloc, typename Count>
+class HashMapBuilder;
+
+template <typename T, typename Hash, typename Alloc, typename Count>
+class HashSetBuilder;
+
+template <typename E, typename Alloc, typename Count>
+class HashStream;
+
+//persistent map from K to V, lookups and updates are O(log32 n)
+template <typename K, typename V, typename Hash = std::hash<K>, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class HashMap
+{
+	friend class HashMapBuilder<K, V, Hash, Alloc, Count>;
+	friend class HashStream<std::pair<K, V>, Alloc, Count>;
+
+	using Trie = HashTrie<MapEntry<K, V>, Hash, Alloc, Count>;
+	using Link = typename Trie::Link;
+
+	Link root;
+	int count;
+
+	HashMap (const Link r, const int c)
+		: root(r), count(c)
+	{}
+
+	public:
+	using Entry = std::pair<K, V>;
+	using Builder = HashMapBuilder<K, V, Hash, Alloc, Count>;
+
+	HashMap (void)
+		: root(nullptr), count(0)
+	{}
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	explicit operator bool (void) const
+	{
+		return count;
+	}
+
+	std::optional<V> get (const K& k) const
+	{
+		const Entry* const e = Trie::find(root.get(), k, Trie::hash(k));
+
+		if(e)
+			return e->second;
+
+		return std::nullopt;
+	}
+
+	bool contains (const K& k) const
+	{
+		return Trie::find(root.get(), k, Trie::hash(k));
+	}
+
+	//copy with k mapped to v, whatever it mapped to before is dropped
+	HashMap set (const K& k, const V& v) const
+	{
+		int added = 0;
+		const Link r = Trie::insert(root, Entry(k, v), Trie::hash(k), 0, true, added);
+
+		return HashMap(r, count + added);
+	}
+
+	//copy without k, this same map when k is not in it
+	HashMap remove (const K& k) const
+	{
+		int removed = 0;
+		const Link r = Trie::erase(root, k, Trie::hash(k), 0, removed);
+
+		return removed ? HashMap(r, count - removed) : *this;
+	}
+};
+
+//persistent set, the same trie as HashMap with the keys as the entries
+template <typename T, typename Hash = std::hash<T>, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class HashSet
+{
+	friend class HashSetBuilder<T, Hash, Alloc, Count>;
+	friend class HashStream<T, Alloc, Count>;
+
+	using Trie = HashTrie<SetEntry<T>, Hash, Alloc, Count>;
+	using Link = typename Trie::Link;
+
+	Link root;
+	int count;
+
+	HashSet (const Link r, const int c)
+		: root(r), count(c)
+	{}
+
+	public:
+	using DataType = T;
+	using Builder = HashSetBuilder<T, Hash, Alloc, Count>;
+
+	HashSet (void)
+		: root(nullptr), count(0)
+	{}
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	explicit operator bool (void) const
+	{
+		return count;
+	}
+
+	bool contains (const T& a) const
+	{
+		return Trie::find(root.get(), a, Trie::hash(a));
+	}
+
+	//copy with a in it, this same set when it already was
+	HashSet push (const T& a) const
+	{
+		int added = 0;
+		const Link r = Trie::insert(root, a, Trie::hash(a), 0, false, added);
+
+		return added ? HashSet(r, count + added) : *this;
+	}
+
+	//copy without a, this same set when it is not in it
+	HashSet remove (const T& a) const
+	{
+		int removed = 0;
+		const Link r = Trie::erase(root, a, Trie::hash(a), 0, removed);
+
+		return removed ? HashSet(r, count - removed) : *this;
+	}
+};
+
+//transient map, writes into nodes it alone holds, freeze is O(1)
+template <typename K, typename V, typename Hash = std::hash<K>, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class HashMapBuilder
+{
+	using M = HashMap<K, V, Hash, Alloc, Count>;
+	using Trie = typename M::Trie;
+
+	typename M::Link root;
+	int count;
+
+	public:
+
+	HashMapBuilder (void)
+		: root(nullptr), count(0)
+	{}
+
+	explicit HashMapBuilder (const M m)
+		: root(m.root), count(m.count)
+	{}
+
+	void set (const K& k, const V& v)
+	{
+		root = Trie::insert(std::move(root), typename M::Entry(k, v), Trie::hash(k), 0, true, count);
+	}
+
+	void remove (const K& k)
+	{
+		int removed = 0;
+		root = Trie::erase(std::move(root), k, Trie::hash(k), 0, removed);
+		count -= removed;
+	}
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	//the map shares our nodes, so anything written afterwards copies them again first
+	M freeze (void) const
+	{
+		return M(root, count);
+	}
+};
+
+template <typename T, typename Hash = std::hash<T>, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class HashSetBuilder
+{
+	using S = HashSet<T, Hash, Alloc, Count>;
+	using Trie = typename S::Trie;
+
+	typename S::Link root;
+	int count;
+
+	public:
+
+	HashSetBuilder (void)
+		: root(nullptr), count(0)
+	{}
+
+	explicit HashSetBuilder (const S s)
+		: root(s.root), count(s.count)
+	{}
+
+	void push (const T& a)
+	{
+		root = Trie::insert(std::move(root), a, Trie::hash(a), 0, false, count);
+	}
+
+	void remove (const T& a)
+	{
+		int removed = 0;
+		root = Trie::erase(std::move(root), a, Trie::hash(a), 0, removed);
+		count -= removed;
+	}
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	S freeze (void) const
+	{
+		return S(root, count);
+	}
+};
+
+//partitioned bloom filter, the bits are cut into one slice per probe and every key sets one bit in each
+//probes come from double hashing two independent mixes of the key's hash, so the rate
+//stays at the textbook one instead of the worse rate of filters that keep a key inside one word
+//unlike the persistent containers above it is written in place
+//
+//bytes and fpr fix how many keys the filter is meant for, bits * ln(2)^2 / -ln(fpr),
+//and the probe count is the best one for that many bits per key, the rate holds up to
+//that many keys and climbs past it
+class BloomFilter
+{
+	std::vector<uint64_t> words;
+	const int hashes;
+	const uint64_t slice; //bits per probe, at least 2 as there are 64 bits or more and 32 probes at most
+
+	//std::hash is often the identity, so spread the bits out first
+	static uint64_t mix (uint64_t h)
+	{
+		h ^= h >> 30;
+		h *= 0xbf58476d1ce4e5b9ull;
+		h ^= h >> 27;
+		h *= 0x94d049bb133111ebull;
+		h ^= h >> 31;
+
+		return h;
+	}
+
+	//x scaled into [0, n) by its high bits, no division
+	static uint64_t scale (const uint64_t x, const uint64_t n)
+	{
+		return uint64_t((unsigned __int128)x * n >> 64);
+	}
+
+	static int probes (const size_t bits, const double fpr)
+	{
+		const double ln2 = std::log(2.0);
+		const double keys = std::max(1.0, bits * ln2 * ln2 / -std::log(fpr));
+
+		return std::clamp(int(std::lround(bits / keys * ln2)), 1, 32);
+	}
+
+	public:
+
+	BloomFilter (const size_t bytes, const double fpr)
+		: words(std::max<size_t>(1, bytes / 8), 0), 
+		  hashes(probes(words.size() * 64, fpr)),
+		  slice(words.size() * 64 / hashes)
+	{}
+
+	//calls f with the word and bit of each probe, stops when f returns false
+	template <typename F>
+	bool probe (const uint64_t hash, F f) const
+	{
+		const uint64_t a = mix(hash);
+		const uint64_t b = mix(hash ^ 0x9e3779b97f4a7c15ull) | 1;
+
+		for(int i = 0; i < hashes; i++)
+		{
+			const uint64_t bit = i * slice + scale(a + i * b, slice);
+			if(!f(bit >> 6, uint64_t(1) << (bit & 63))) return false;
+		}
+
+		return true;
+	}
+
+	//true when the key was probably added before
+	bool contains (const uint64_t hash) const
+	{
+		return probe(hash, [&](const size_t w, const uint64_t mask){ return bool(words[w] & mask);});
+	}
+
+	//adds a key by its hash, true when it was probably there already
+	bool insert (const uint64_t hash)
+	{
+		bool seen = true;
+		probe(hash, [&](const size_t w, const uint64_t mask){ 
+			seen = seen && (words[w] & mask);
+			words[w] |= mask;
+			return true;
+		});
+
+		return seen;
+	}
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "utility.h"
+#include "list.h"
+#include "ref.h"
+
+//node of a leftist heap, rank is the length of its right spine
+//the left child never has the smaller rank, so right spines stay O(log n) long
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+struct HeapNode : public Counted<Count, Alloc>
+{
+	using SharedNode = Ref<HeapNode>;
+
+	const T res;
+	SharedNode left;  //only written by the destructor
+	SharedNode right;
+	const int rank;
+
+	HeapNode (const T r, const SharedNode l = nullptr, const SharedNode rt = nullptr, const int k = 1)
+		: res(r), left(l), right(rt), rank(k)
+	{}
+
+	//left spines can be as long as the heap, so they are freed with a stack
+	~HeapNode (void)
+	{
+		if(!left.unique() && !right.unique())
+			return;
+
+		std::vector<SharedNode> pending;
+
+		if(left.unique())  pending.push_back(std::move(left));
+		if(right.unique()) pending.push_back(std::move(right));
+
+		while(!pending.empty())
+		{
+			const SharedNode n = std::move(pending.back());
+			pending.pop_back();
+
+			if(n->left.unique())  pending.push_back(std::move(n->left));
+			if(n->right.unique()) pending.push_back(std::move(n->right));
+		}
+	}
+};
+
+template <typename T, Ord<T> Compare, typename Alloc, typename Count>
+class HeapBuilder;
+
+//persistent priority queue, peek is O(1), push, pop and merge copy O(log n) nodes
+//and share the rest, so every older version stays usable
+//the smallest element is the one Compare puts first, the same order Tree and mergeSort use
+//equal elements come out in no particular order
+template <typename T, Ord<T> Compare = ordOverload, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class Heap
+{
+	friend class HeapBuilder<T, Compare, Alloc, Count>;
+
+	using Node = HeapNode<T, Alloc, Count>;
+	using SharedNode = Ref<Node>;
+
+	SharedNode head;
+	int count;
+
+	Heap (const SharedNode h, const int c)
+		: head(h), count(c)
+	{}
+
+	static int rank (const SharedNode& n)
+	{
+		return n ? n->rank : 0;
+	}
+
+	//node over a and b with the higher ranked one on the left
+	static SharedNode join (const T& res, const SharedNode& a, const SharedNode& b)
+	{
+		if(rank(a) < rank(b))
+			return SharedNode::make(res, b, a, rank(a) + 1);
+
+		return SharedNode::make(res, a, b, rank(b) + 1);
+	}
+
+	//walks down both right spines, so it only recurses O(log n) deep
+	static SharedNode merge (const SharedNode& a, const SharedNode& b)
+	{
+		if(!a) return b;
+		if(!b) return a;
+
+		if(Compare(a->res, b->res))
+			return join(b->res, b->left, merge(a, b->right));
+
+		return join(a->res, a->left, merge(a->right, b));
+	}
+
+	public:
+	using DataType = T;
+	using Builder = HeapBuilder<T, Compare, Alloc, Count>;
+
+	Heap (void)
+		: head(nullptr), count(0)
+	{}
+
+	//heapifies in O(n)
+	template <typename N>
+	Heap (const List<T, N> l);
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	explicit operator bool (void) const
+	{
+		return count;
+	}
+
+	T peek (void) const
+	{
+		if(head)
+			return head->res;
+
+		throw std::out_of_range("peeking an empty Heap");
+	}
+
+	Heap pop (void) const
+	{
+		if(head)
+			return Heap(merge(head->left, head->right), count - 1);
+
+		throw std::out_of_range("popping an empty Heap");
+	}
+
+	Heap push (const T res) const
+	{
+		return Heap(merge(head, SharedNode::make(res)), count + 1);
+	}
+
+	Heap merge (const Heap& a) const
+	{
+		return Heap(merge(head, a.head), count + a.count);
+	}
+};
+
+//collects elements and heapifies them all at once when frozen
+//merging pairs of heaps round by round builds the whole thing in O(n)
+template <typename T, Ord<T> Compare = ordOverload, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class HeapBuilder
+{
+	using H = Heap<T, Compare, Alloc, Count>;
+	using SharedNode = typename H::SharedNode;
+
+	std::vector<SharedNode> pending;
+	int count;
+
+	public:
+
+	HeapBuilder (void)
+		: count(0)
+	{}
+
+	explicit HeapBuilder (const H h)
+		: count(h.count)
+	{
+		if(h.head) pending.push_back(h.head);
+	}
+
+	void append (const T res)
+	{
+		pending.push_back(SharedNode::make(res));
+		count++;
+	}
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	H freeze (void)
+	{
+		while(pending.size() > 1)
+		{
+			size_t out = 0;
+
+			for(size_t i = 0; i + 1 < pending.size(); i += 2)
+				pending[out++] = H::merge(pending[i], pending[i + 1]);
+
+			if(pending.size() % 2)
+				pending[out++] = std::move(pending.back());
+
+			pending.resize(out);
+		}
+
+		const H heap(pending.empty() ? nullptr : pending.back(), count);
+
+		pending.clear();
+		count = 0;
+
+		return heap;
+	}
+};
+
+template <typename T, Ord<T> Compare, typename Alloc, typename Count>
+template <typename N>
+Heap<T, Compare, Alloc, Count>::Heap (const List<T, N> l)
+	: Heap()
+{
+	HeapBuilder<T, Compare, Alloc, Count> out;
+	l.foldr([&](const T& a){ out.append(a);});
+
+	*this = out.freeze();
+}
+
+#endif
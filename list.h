@@ -7,44 +7,286 @@
 #include <iostream> 
 #include <optional>
 #include <tuple> 
+#include <vector>
+#include <atomic>
+#include <new>
 #include "utility.h" 
+#include "ref.h"
 //singly linked list 
 //nodes are shared between list tails thanks to being persistent 
-//ref counted with shared_ptr 
+//intrusively ref counted, see ref.h 
 //ref counted child node 
 //
-//
-template<typename T> 
-struct ListNode 
+//a node type doubles as the layout policy of a List, 
+//List only ever touches its head through cons/first/rest, 
+//the length lives in the List itself so nodes carry nothing but the element 
+//Alloc picks where nodes live, see arena.h, Count picks atomic or plain counting 
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount> 
+struct ListNode : public Counted<Count, Alloc>
 {
+	using Link = Ref<ListNode>;
+
 	const T res; 
-	const std::shared_ptr<ListNode<T>> next; 
-	const int length;
+	Link next; //only written by a Builder before the node is shared, and taken apart by the destructor 
 
-	ListNode (const T r, const std::shared_ptr<ListNode<T>> n = nullptr)
-		:res(r), next(n), length(n == nullptr? 1 : 1 + n->length)
+	ListNode (const T r, const Link n = nullptr)
+		:res(r), next(n)
 	{}
+
+	//unlinks tails nobody else holds one at a time, 
+	//so dropping a long list doesn't recurse once per node 
+	~ListNode (void)
+	{
+		Link n = std::move(next);
+
+		while(n.unique())
+		{
+			Link t = std::move(n->next);
+			n = std::move(t);
+		}
+	}
+
+	static Link cons (const T r, const Link n)
+	{
+		return Link::make(r, n);
+	}
+
+	static const T& first (const Link& l)
+	{
+		return l->res;
+	}
+
+	static Link rest (const Link& l)
+	{
+		return l->next;
+	}
+
+	//builds a list front to back by appending to a tail nobody else can see yet 
+	class Builder 
+	{
+		Link head; 
+		ListNode* last = nullptr;
+
+		public:
+		void append (const T r)
+		{
+			Link n = Link::make(r, nullptr);
+			ListNode* const l = n.get();
+
+			if(last) last->next = std::move(n);
+			else head = std::move(n);
+
+			last = l;
+		}
+
+		//hands the nodes over with tail shared onto the end, the builder is empty afterwards 
+		Link seal (const Link tail = nullptr)
+		{
+			if(!last)
+				return tail;
+
+			last->next = tail;
+			last = nullptr;
+
+			return std::move(head);
+		}
+	};
+};
+
+//unrolled node, holds up to N elements in one block so walking a list 
+//stays inside the same few cache lines instead of chasing a pointer per element 
+//
+//elements fill the block from the back, a list is a (block, index) pair 
+//pushing onto a list that starts at the lowest claimed slot of its block 
+//claims the slot below it, every other push copies into a fresh block 
+//so tails are still shared and nothing visible is ever written twice 
+template<typename T, int N = 16, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+struct ChunkNode : public Counted<Count, Alloc>
+{
+	static_assert(N > 0, "chunks need at least one slot");
+
+	struct Link 
+	{
+		Ref<ChunkNode> chunk; 
+		int index;
+
+		Link (std::nullptr_t = nullptr)
+			: chunk(nullptr), index(0)
+		{}
+
+		Link (const Ref<ChunkNode> c, const int i)
+			: chunk(c), index(i)
+		{}
+
+		explicit operator bool (void) const
+		{
+			return chunk != nullptr;
+		}
+
+		bool operator == (const Link& a) const
+		{
+			return chunk == a.chunk && index == a.index;
+		}
+	};
+
+	alignas(T) unsigned char slots[N * sizeof(T)];
+	mutable std::atomic<int> front; //lowest constructed slot, only ever moves down 
+	int back;                       //one past the highest constructed slot 
+	Link next;                      //back and next are only written by a Builder before 
+	                                //the block is shared, and by the destructor 
+
+	ChunkNode (const T r, const Link n)
+		: front(N - 1), back(N), next(n)
+	{
+		new (slot(N - 1)) T(r);
+	}
+
+	//empty block for a Builder to fill from the front 
+	ChunkNode (void)
+		: front(0), back(0), next(nullptr)
+	{}
+
+	ChunkNode (const ChunkNode&) = delete;
+
+	~ChunkNode (void)
+	{
+		for(int i = front.load(std::memory_order_relaxed); i < back; i++)
+			slot(i)->~T();
+
+		//same as ListNode, one block at a time 
+		Link n = std::move(next);
+
+		while(n.chunk.unique())
+		{
+			Link t = std::move(n.chunk->next);
+			n = std::move(t);
+		}
+	}
+
+	T* slot (const int i) const
+	{
+		return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(slots) + i * sizeof(T)));
+	}
+
+	static Link cons (const T r, const Link n)
+	{
+		if(n && n.index > 0)
+		{
+			int expected = n.index;
+
+			if(n.chunk->front.compare_exchange_strong(expected, n.index - 1))
+			{
+				try
+				{
+					new (n.chunk->slot(n.index - 1)) T(r);
+				}
+				catch (...)
+				{
+					//nobody else can hold a link below n.index yet, so this always succeeds 
+					n.chunk->front.store(n.index);
+					throw;
+				}
+
+				return Link(n.chunk, n.index - 1);
+			}
+		}
+
+		return Link(Ref<ChunkNode>::make(r, n), N - 1);
+	}
+
+	static const T& first (const Link& l)
+	{
+		return *l.chunk->slot(l.index);
+	}
+
+	static Link rest (const Link& l)
+	{
+		if(l.index + 1 < l.chunk->back)
+			return Link(l.chunk, l.index + 1);
+
+		return l.chunk->next;
+	}
+
+	//fills blocks front to back, blocks built this way start at slot 0 
+	//so pushes onto them always go to a fresh block 
+	class Builder 
+	{
+		Ref<ChunkNode> head; 
+		ChunkNode* last = nullptr;
+
+		public:
+		void append (const T r)
+		{
+			if(!last || last->back == N)
+			{
+				Ref<ChunkNode> c = Ref<ChunkNode>::make();
+				ChunkNode* const l = c.get();
+
+				if(last) last->next = Link(std::move(c), 0);
+				else head = std::move(c);
+
+				last = l;
+			}
+
+			new (last->slot(last->back)) T(r);
+			last->back++;
+		}
+
+		Link seal (const Link tail = nullptr)
+		{
+			if(!last)
+				return tail;
+
+			last->next = tail;
+			last = nullptr;
+
+			return Link(std::move(head), 0);
+		}
+	};
 };
 
+template <typename T, typename Node>
+class ListBuilder;
+
+template <typename T, typename Node>
+class ListStream;
+
 //just a node and a few constructors 
-template <typename T>
+template <typename T, typename Node = ListNode<T>>
 struct List 
 {
 public: using DataType = T;
+		using NodeType = Node;
 private:
-	std::shared_ptr<ListNode<T>> head; 
+	template <typename, typename> friend struct List;
+	friend class ListBuilder<T, Node>;
+	friend class ListStream<T, Node>;
 
-	List reverseBuilder (const List l = List( List::SharedNode(nullptr))) const 
-	{
-		if(length() == 0)
-				return l; 
+	typename Node::Link head; 
+	int size;
 
-		if(length() == 1)
-			return l.push(peek());
+	//everything below walks with loops, building results front to back 
+	//through a ListBuilder, so nothing recurses once per element 
+	using Builder = ListBuilder<T, Node>;
 
-		const List out = l.push(peek()); 
+	List (const typename Node::Link h, const int s)
+		: head(h), size(s)
+	{}
+
+	//calls fun on each element front to back, stops early when fun returns false 
+	template <typename F>
+	void walk (F fun) const
+	{
+		for(typename Node::Link i = head; i; i = Node::rest(i))
+			if(!fun(Node::first(i))) return;
+	}
+
+	List reverseBuilder (const List l = List()) const 
+	{
+		List out = l;
+		walk([&](const T& a){ out = out.push(a); return true;});
 
-		return pop().reverseBuilder(out);
+		return out;
 	}
 
 	struct Iterator 
@@ -77,45 +319,43 @@ private:
 		}
 	};
 
-	List initBuild (const std::initializer_list<T> init, const int pos = 0) //crappy {} constructor, make it a member with a helper function
+	static List initBuild (const std::initializer_list<T> init)
 	{
-		if(pos + 1 > init.size())
-			return List<T>();
+		Builder out;
+		for(const T& a : init) out.append(a);
 
-		return List(*(init.begin() + pos)).push( initBuild(init, pos + 1)); 
+		return out.freeze();
 	}
 
 
 
 public:
 
-	using SharedNode = std::shared_ptr<ListNode<T>>;
-
+	using SharedNode = typename Node::Link;
 
-	explicit List(T r, std::shared_ptr<ListNode<T>> h = nullptr)
-		: head(std::make_shared<ListNode<T>>(r,h))
-	{}
 
-	List(std::shared_ptr<ListNode<T>> h)
-		: head(h)
+	explicit List (void)
+		: head(nullptr), size(0)
 	{}
 
-	explicit List (void)
-		: head(nullptr)
+	//one element, lists over existing nodes are only made inside, where the length is known 
+	explicit List (const T r)
+		: head(Node::cons(r, nullptr)), size(1)
 	{}
 
 	List (const List& a)
-		: head(a.head)
+		: head(a.head), size(a.size)
 	{}
 
 	List (const std::initializer_list<T> l) 
-		: head(initBuild(l).reverse().head)
+		: List(initBuild(l))
 	{}
 
 
 	List& operator = (const List& a)
 	{
 		head = a.head;
+		size = a.size;
 		return *this;
 	}
 
@@ -133,17 +373,16 @@ public:
 
 	bool operator == (const List& a) const
 	{
-		if(length() == 0 && a.length() == 0)
-			return true; 
-
 		if(length() != a.length())
 			return false; 
 
-		if (peek() != a.peek())
-			return false;
+		typename Node::Link i = head, j = a.head;
 
+		for(; i && !(i == j); i = Node::rest(i), j = Node::rest(j))
+			if (Node::first(i) != Node::first(j))
+				return false;
 
-		return pop() == a.pop();
+		return true;
 	}
 
 	bool operator != (const List& a) const
@@ -155,10 +394,7 @@ public:
 	//0 length for empty lists, 1 is just a node, 2+ has tail 
 	int length (void) const
 	{
-		if(!head)
-			return 0;
-
-		return head->length;
+		return size;
 
 		/*
 		if(!head->next)
@@ -178,17 +414,14 @@ public:
 	//a->b .. c->a->b 
 	List push ( const T res) const//pushes an element to the head of a list
 	{
-		if(length() == 0)
-			return List(res);
-
-		return List(res, head);
+		return List(Node::cons(res, head), size + 1);
 	}
 
 	//a->b .. a
 	T peek (void) const//returns first element of List 
 	{
 		if(length())
-			return head->res;
+			return Node::first(head);
 
 		throw std::out_of_range("peeking a List of size zero");
 	}
@@ -197,7 +430,7 @@ public:
 	List pop (void) const //returns a list where the head is gone 
 	{
 		if(length() > 1)
-			return List(head->next);
+			return List(Node::rest(head), size - 1);
 
 		return List(); 
 	}
@@ -205,24 +438,24 @@ public:
 	//a->b->c .. c
 	T peek_back (void) const //returns last element of a List
 	{
-		if(length() > 1)
-			return pop().peek_back();
+		if(!length())
+			return peek();
+
+		typename Node::Link i = head; 
+		for(int n = size; n > 1; n--) i = Node::rest(i);
 
-		return peek();
+		return Node::first(i);
 	}
 
 	//a->b->c .. //na->nb 
 	List pop_back (void) const //returns the List minus the tail element a-b-c .. na-b 
 	{
-		if(length() > 1)
-		{
-			if(length() > 2)
-				return List( peek(), pop().pop_back().head);
+		Builder out;
+		int left = length() - 1;
 
-			return List(peek());
-		}
+		walk([&](const T& a){ if(left-- > 0) out.append(a); return left > 0;});
 
-		return List();
+		return out.freeze();
 	};
 
 
@@ -234,27 +467,24 @@ public:
 		if(!b.length())
 		   return *this;
 
-		if(length() < 2)
-			return b.push_back(peek());
+		//copies b, our nodes are shared as its tail 
+		Builder out;
+		b.walk([&](const T& a){ out.append(a); return true;});
 
-		return b.foldr( [](const auto a, const auto list){ return a + list;}, *this);
-
-		//return pop_back().push_back(b.push( peek_back()));
+		return out.freeze(*this);
 	}
 
 	List push_back (const T res) const //puts an element at the back of a list
 	{
-		if(!length())
-			return List(res);
+		Builder out;
+		walk([&](const T& a){ out.append(a); return true;});
+		out.append(res);
 
-		if(length() > 1)
-			return pop().push_back(res).push(peek());
-
-		return List<T>( peek(), std::make_shared<ListNode<T>>(res));
+		return out.freeze();
 	}
 
 	//a->b->c, d->e->f ... n(d->e->f->a->b->c)
-	List push_back (const List<T> b) const//combines two lists together, but B is infront of A
+	List push_back (const List b) const//combines two lists together, but B is infront of A
 	{
 		return b.push(*this);
 	}
@@ -270,13 +500,15 @@ public:
 		return reverseBuilder();
 	}
 
+	//the first end + 1 elements of in, reversed onto out 
 	List sliceBuilder (const List in , const int end, const List out = List()) const 
 	{
-		if(end == 0)
-			return out.push(in.peek()); 
+		List acc = out;
+		int left = end + 1;
 
+		in.walk([&](const T& a){ acc = acc.push(a); return --left > 0;});
 
-		return sliceBuilder( in.pop(), end - 1, out.push(in.peek()));
+		return acc;
 	}
 		
 		
@@ -290,96 +522,117 @@ public:
 
 		if(start > end)
 			throw std::out_of_range("start of split is after end");
-			
-		if(start > 0)
-			return pop().slice( start - 1, end -1);
 
-		if(end - start < length()- 1)
-			return sliceBuilder(*this, end).reverse();
+		typename Node::Link i = head;
+		for(int s = start; s > 0; s--) i = Node::rest(i);
 
-		return *this;
+		//a slice that runs to the end is just a shared tail 
+		if(end == length() - 1)
+			return List(i, size - start);
+
+		Builder out;
+		for(int s = start; s <= end; s++, i = Node::rest(i))
+			out.append(Node::first(i));
+
+		return out.freeze();
 	}
 
 	List find (T res) const
 	{
-		if (length() == 0)
-			return *this;
-
-		if (peek() == res)
-		{
-			return *this;
-		}
+		int n = size;
+		for(typename Node::Link i = head; i; i = Node::rest(i), n--)
+			if (Node::first(i) == res)
+				return List(i, n);
 
-		return  pop().find(res);
+		return List();
 	}
 
-	List<List<T>> split (T res, int l = -1) const
+	List<List> split (T res, int l = -1) const
 	{
 		return splitHelper(res, l).filter([](const auto l){ return l.length();});
 	}
 
-	List< List<T>> splitHelper (T res, int l , List<T> stack = List<T>(), List< List<T>> output = List<List<T>>() ) const 
+	//splits on res at most l times, stack is the piece being built and output the pieces so far 
+	List<List> splitHelper (T res, int l , List stack = List(), List<List> output = List<List>() ) const 
 	{
-		if( length() == 0)
-			return output + stack; 
+		ListBuilder<List, typename List<List>::NodeType> pieces;
+		output.walk([&](const List& a){ pieces.append(a); return true;});
+
+		Builder piece;
+		stack.walk([&](const T& a){ piece.append(a); return true;});
+
+		typename Node::Link i = head;
+		int n = size;
+		for(; i && l != 0; i = Node::rest(i), n--)
+		{
+			if(Node::first(i) != res)
+			{
+				piece.append(Node::first(i));
+				continue;
+			}
+
+			pieces.append(piece.freeze());
+			l--;
+		}
 
-		if( l == 0)
-			return (output + stack) + *this;
+		pieces.append(piece.freeze());
 
-		if( peek() != res)
-			return pop().splitHelper(res, l, stack + peek(), output);
+		//out of splits, the rest goes in whole 
+		if(i) pieces.append(List(i, n));
 
-		return pop().splitHelper(res, l - 1, List<T>(), output + stack); 
+		return pieces.freeze();
 	};
 
-	List find (const List<T> l) const
+	//the first position l starts at 
+	List find (const List l) const
 	{
 		if (l.length() == 0)
 			return List(); 
 
-		if (length() == 0)
-			return *this;
-
-		if (peek() == l.peek())
+		int n = size;
+		for(typename Node::Link i = head; n >= l.length(); i = Node::rest(i), n--)
 		{
-			if (split(0, l.length() -1) == l)
-				return *this;
+			typename Node::Link a = i, b = l.head;
+			while(b && Node::first(a) == Node::first(b))
+			{
+				a = Node::rest(a);
+				b = Node::rest(b);
+			}
+
+			if(!b) return List(i, n);
 		}
 
-		return pop().find(l);
+		return List();
 	}
 
 	template <typename F = T(T)>
 	List map (const F fun) const
 	{
-		if (length() == 0)
-			return List();
-
-		if (length() == 1)
-			return List( fun( peek()));
+		Builder out;
+		walk([&](const T& a){ out.append(fun(a)); return true;});
 
-		return fun(peek()) + pop().map(fun);
+		return out.freeze();
 	}
 
 	template < typename G, typename F = std::function<G(T,G)>>
 	G foldr ( F fun, G init) const
 	{
-		if (length() == 0)
-			return init;
+		//a right fold has to see the back first, so remember where everything is 
+		std::vector<const T*> elements;
+		elements.reserve(length());
+		walk([&](const T& a){ elements.push_back(&a); return true;});
 
-		return fun( peek(), pop().foldr(fun, init));
+		G acc = init;
+		for(auto i = elements.rbegin(); i != elements.rend(); i++)
+			acc = fun(**i, acc);
 
+		return acc;
 	}
 
 	template <typename F = std::function<void(T)>>
 	void foldr (F fun) const 
 	{
-		if (length() == 0)
-			return; 
-
-		fun(peek());
-
-		return pop().foldr(fun);
+		walk([&](const T& a){ fun(a); return true;});
 	}
 
 
@@ -388,35 +641,30 @@ public:
 	template <typename G, typename F = std::function<G(T,G)>>
 	G foldl (F fun, G init) const
 	{
-		if (length() == 0)
-			return init;
-
-		return reverse().foldr( fun, init);
+		G acc = init;
+		walk([&](const T& a){ acc = fun(a, acc); return true;});
 
-		//return fun( peek_back(), pop_back().foldl( fun, init));
+		return acc;
 	}
 
 	template <typename F = std::function<bool(T)>>
 	List filter (F fun) const
 	{
-		if (length() == 0)
-			return *this;
+		Builder out;
+		walk([&](const T& a){ if(fun(a)) out.append(a); return true;});
 
-		if (fun(peek()))
-			return peek() + pop().filter(fun);
-
-		return pop().filter(fun);
+		return out.freeze();
 	}
 
 	T operator [] (int i) const
 	{
-		if (i + 1> length())
+		if (i < 0 || i + 1> length())
 			throw std::out_of_range("[] trying to access an out of range element");
 
-		if(i == 0)
-			return peek(); 
+		typename Node::Link n = head;
+		for(; i > 0; i--) n = Node::rest(n);
 
-		return pop()[i - 1];
+		return Node::first(n);
 	}
 
 
@@ -437,41 +685,76 @@ public:
 
 };
 
+//transient list, appends in place while nobody else can see the nodes 
+//and hands them over as an ordinary persistent List in O(1) 
+template <typename T, typename Node = ListNode<T>>
+class ListBuilder 
+{
+	typename Node::Builder nodes; 
+	int size = 0;
+
+	public:
+	void append (const T r)
+	{
+		nodes.append(r);
+		size++;
+	}
+
+	int length (void) const
+	{
+		return size;
+	}
+
+	//tail is shared onto the end, the builder starts over empty afterwards 
+	List<T, Node> freeze (const List<T, Node> tail = List<T, Node>())
+	{
+		const int s = size + tail.length();
+		size = 0;
+
+		return List<T, Node>(nodes.seal(tail.head), s);
+	}
+};
+
+//unrolled list, same persistent api but N elements per heap block 
+template <typename T, int N = 16>
+using ChunkList = List<T, ChunkNode<T, N>>;
+
 template <typename T>
 List<T> mergeSort (const List<T> l, const Ord<T> compare = ordOverload);
 
 
-	template<typename T>
-	List<T> operator+ (const List<T> a,  const T b)
+	template<typename T, typename N>
+	List<T, N> operator+ (const List<T, N> a,  const T b)
 	{
 		return a.push_back(b);
 	}
 
-	template<typename T>
-	List<T> operator+ (const T a, const List<T> b)
+	template<typename T, typename N>
+	List<T, N> operator+ (const T a, const List<T, N> b)
 	{
 		return b.push(a);
 	}
 
-	template<typename T>
-	List<T> operator + (const List<T>a, const List<T> b)
+	template<typename T, typename N>
+	List<T, N> operator + (const List<T, N>a, const List<T, N> b)
 	{
 		return a.push_back(b);
 	}
 
-	template<typename T>
-	bool operator > (const List<T> a, const List<T> b)
+	template<typename T, typename N>
+	bool operator > (const List<T, N> a, const List<T, N> b)
 	{
-		if(a.length() && !b.length()) return true; 
-		if(!a.length() || !b.length()) return false; 
-		if( a.peek() > b.peek()) return true; 
+		List<T, N> i = a, j = b;
+
+		for(; i.length() && j.length(); i = i.pop(), j = j.pop())
+			if( i.peek() > j.peek()) return true; 
 
-		return a.pop() > b.pop();
+		return i.length() && !j.length();
 	}
 
 
-	template<typename T>
-	bool operator < (const List<T> a, const List<T> b)
+	template<typename T, typename N>
+	bool operator < (const List<T, N> a, const List<T, N> b)
 	{
 		return ( b > a);
 	}
@@ -480,37 +763,25 @@ List<T> mergeSort (const List<T> l, const Ord<T> compare = ordOverload);
 
 
 	//replace with an IO monad or something
-	template<typename T>
-	std::ostream& operator<< (std::ostream& os, const List<T>& l) //ostreams the elements, maybe move this OUT of the lib because OS isn't const 
+	template<typename T, typename N>
+	std::ostream& operator<< (std::ostream& os, const List<T, N>& l) //ostreams the elements, maybe move this OUT of the lib because OS isn't const 
 	{
-		if(!l.length())
-			return os;
-
-		os << l.peek();
-		
-		return os << ',' << l.pop();
+		l.foldr([&](const T& a){ os << a << ',';});
+		return os;
 	}
 
-	std::ostream& operator<< (std::ostream& os, const List<char>& l) //ostreams the elements, maybe move this OUT of the lib because OS isn't const 
+	template<typename N>
+	std::ostream& operator<< (std::ostream& os, const List<char, N>& l) //ostreams the elements, maybe move this OUT of the lib because OS isn't const 
 	{
-		if(!l.length())
-			return os;
-
-		os << l.peek();
-		
-		return os << l.pop();
+		l.foldr([&](const char a){ os << a;});
+		return os;
 	}
 
-	template<typename T>
-	std::ostream& operator<< (std::ostream& os, const List<List<T>>& l) //ostreams the elements, maybe move this OUT of the lib because OS isn't const 
+	template<typename T, typename N, typename M>
+	std::ostream& operator<< (std::ostream& os, const List<List<T, N>, M>& l) //ostreams the elements, maybe move this OUT of the lib because OS isn't const 
 	{
-
-		if(!l.length())
-			return os;
-
-		os << '[' << l.peek() << ']';
-		
-		return os << l.pop();
+		l.foldr([&](const List<T, N>& a){ os << '[' << a << ']';});
+		return os;
 	}
 
 	
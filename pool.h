@@ -0,0 +1,237 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//work stealing thread pool for fork/join style recursion
+//every worker has its own deque, it pushes and pops its own work at the back
+//and steals the oldest (biggest) work from the front of everyone else's
+//a thread waiting on a join runs other tasks instead of blocking, so nested forks can't deadlock
+class Pool
+{
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<std::function<void(void)>> tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+
+	std::atomic<int> queued;
+	std::atomic<bool> stopping;
+	std::atomic<unsigned> nextVictim;
+
+	std::mutex sleepLock;
+	std::condition_variable sleep;
+
+	//which pool and deque the calling thread works for
+	static inline thread_local const Pool* current = nullptr;
+	static inline thread_local size_t self = 0;
+
+	bool runOne (const size_t start)
+	{
+		for(size_t n = 0; n < workers.size(); n++)
+		{
+			Worker& w = *workers[(start + n) % workers.size()];
+			std::function<void(void)> task;
+
+			{
+				const std::lock_guard<std::mutex> guard(w.lock);
+				if(w.tasks.empty()) continue;
+
+				//our own deque is a stack, other deques are queues
+				if(n == 0 && current == this)
+				{
+					task = std::move(w.tasks.back());
+					w.tasks.pop_back();
+				}
+				else
+				{
+					task = std::move(w.tasks.front());
+					w.tasks.pop_front();
+				}
+			}
+
+			queued--;
+			task();
+			return true;
+		}
+
+		return false;
+	}
+
+	void work (const size_t i)
+	{
+		current = this;
+		self = i;
+
+		while(!stopping)
+		{
+			if(runOne(i)) continue;
+
+			std::unique_lock<std::mutex> guard(sleepLock);
+			sleep.wait(guard, [&](){ return stopping || queued > 0;});
+		}
+	}
+
+	void submit (std::function<void(void)> task)
+	{
+		//workers keep their own forks close, outsiders spread theirs around
+		const size_t i = current == this ? self : nextVictim++ % workers.size();
+
+		{
+			const std::lock_guard<std::mutex> guard(workers[i]->lock);
+			workers[i]->tasks.push_back(std::move(task));
+		}
+
+		queued++;
+
+		const std::lock_guard<std::mutex> guard(sleepLock);
+		sleep.notify_one();
+	}
+
+	public:
+
+	//result of a fork, join it exactly once
+	template <typename R>
+	class Job
+	{
+		friend class Pool;
+
+		struct State
+		{
+			std::atomic<bool> done = false;
+			std::optional<std::conditional_t<std::is_void_v<R>, bool, R>> result;
+			std::exception_ptr error;
+		};
+
+		std::shared_ptr<State> state;
+
+		Job (const std::shared_ptr<State> s)
+			: state(s)
+		{}
+	};
+
+	explicit Pool (const size_t n = std::thread::hardware_concurrency())
+		: queued(0), stopping(false), nextVictim(0)
+	{
+		const size_t size = n ? n : 1;
+
+		for(size_t i = 0; i < size; i++)
+			workers.push_back(std::make_unique<Worker>());
+
+		for(size_t i = 0; i < size; i++)
+			threads.emplace_back([this, i](){ work(i);});
+	}
+
+	Pool (const Pool&) = delete;
+
+	~Pool (void)
+	{
+		{
+			const std::lock_guard<std::mutex> guard(sleepLock);
+			stopping = true;
+		}
+
+		sleep.notify_all();
+		for(auto& t : threads) t.join();
+	}
+
+	//one pool for the whole program, sized to the machine
+	static Pool& shared (void)
+	{
+		static Pool pool;
+		return pool;
+	}
+
+	size_t size (void) const
+	{
+		return workers.size();
+	}
+
+	template <typename F>
+	auto fork (F fun) -> Job<decltype(fun())>
+	{
+		using R = decltype(fun());
+		const auto state = std::make_shared<typename Job<R>::State>();
+
+		submit([state, fun](){
+			try
+			{
+				if constexpr (std::is_void_v<R>)
+				{
+					fun();
+					state->result.emplace(true);
+				}
+				else
+					state->result.emplace(fun());
+			}
+			catch (...)
+			{
+				state->error = std::current_exception();
+			}
+
+			state->done.store(true, std::memory_order_release);
+		});
+
+		return Job<R>(state);
+	}
+
+	//helps out with queued work until the job is done
+	template <typename R>
+	R join (const Job<R> job)
+	{
+		const size_t start = current == this ? self : 0;
+
+		while(!job.state->done.load(std::memory_order_acquire))
+			if(!runOne(start))
+				std::this_thread::yield();
+
+		if(job.state->error)
+			std::rethrow_exception(job.state->error);
+
+		if constexpr (!std::is_void_v<R>)
+			return std::move(*job.state->result);
+	}
+
+	//runs one queued task on the calling thread, false if there was nothing to do
+	//for callers waiting on something other than a Job, so they help instead of blocking
+	bool help (void)
+	{
+		return runOne(current == this ? self : 0);
+	}
+
+	//runs a and b, possibly at the same time, and returns both results
+	template <typename A, typename B>
+	auto both (A a, B b) -> std::pair<decltype(a()), decltype(b())>
+	{
+		const auto job = fork(a);
+		auto second = b();
+
+		return std::make_pair(join(job), std::move(second));
+	}
+};
+
+//tag for the parallel overloads, work goes to the shared pool unless told otherwise
+struct Parallel
+{
+	Pool& pool;
+
+	Parallel (Pool& p = Pool::shared())
+		: pool(p)
+	{}
+};
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef REF_H
+#define REF_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "arena.h"
+
+//reference counting policies for persistent nodes
+//the count lives in the node itself, so a node is one allocation with a one word header
+
+//safe to share between threads, every copy is an atomic increment
+struct AtomicCount
+{
+	using Type = std::atomic<int>;
+
+	static void acquire (Type& c)
+	{
+		c.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//true when that was the last reference
+	static bool release (Type& c)
+	{
+		return c.fetch_sub(1, std::memory_order_acq_rel) == 1;
+	}
+
+	static int load (const Type& c)
+	{
+		return c.load(std::memory_order_acquire);
+	}
+};
+
+//plain int, only for structures that never leave one thread
+struct LocalCount
+{
+	using Type = int;
+
+	static void acquire (Type& c)
+	{
+		c++;
+	}
+
+	static bool release (Type& c)
+	{
+		return --c == 0;
+	}
+
+	static int load (const Type& c)
+	{
+		return c;
+	}
+};
+
+//single threaded programs can drop the atomics everywhere at once with -DFUN_LOCAL_COUNT
+#ifdef FUN_LOCAL_COUNT
+using DefaultCount = LocalCount;
+#else
+using DefaultCount = AtomicCount;
+#endif
+
+//header for intrusively counted nodes, carries the policies Ref needs to free them
+template <typename Count = DefaultCount, typename Alloc = HeapAlloc>
+struct Counted
+{
+	using CountPolicy = Count;
+	using AllocPolicy = Alloc;
+
+	mutable typename Count::Type refs;
+
+	Counted (void)
+		: refs(0)
+	{}
+
+	Counted (const Counted&)
+		: refs(0)
+	{}
+};
+
+//intrusive shared pointer to a Counted node
+template <typename N>
+class Ref
+{
+	N* node;
+
+	explicit Ref (N* const n)
+		: node(n)
+	{
+		if(node) N::CountPolicy::acquire(node->refs);
+	}
+
+	//nodes with a variable length tail after them say how big they are, see HashNode
+	static size_t bytes (const N* const n)
+	{
+		if constexpr (requires { n->bytes(); })
+			return n->bytes();
+		else
+			return sizeof(N);
+	}
+
+	void release (void)
+	{
+		if(node && N::CountPolicy::release(node->refs))
+		{
+			const size_t size = bytes(node);
+
+			node->~N();
+			N::AllocPolicy::deallocate(node, size, alignof(N));
+		}
+	}
+
+	public:
+
+	Ref (std::nullptr_t = nullptr)
+		: node(nullptr)
+	{}
+
+	Ref (const Ref& a)
+		: Ref(a.node)
+	{}
+
+	Ref (Ref&& a) noexcept
+		: node(a.node)
+	{
+		a.node = nullptr;
+	}
+
+	Ref& operator = (const Ref& a)
+	{
+		Ref(a).swap(*this);
+		return *this;
+	}
+
+	Ref& operator = (Ref&& a) noexcept
+	{
+		Ref(std::move(a)).swap(*this);
+		return *this;
+	}
+
+	~Ref (void)
+	{
+		release();
+	}
+
+	template <typename... A>
+	static Ref make (A&&... args)
+	{
+		return makeSized(sizeof(N), std::forward<A>(args)...);
+	}
+
+	//for nodes that keep a tail of size - sizeof(N) bytes right after themselves
+	template <typename... A>
+	static Ref makeSized (const size_t size, A&&... args)
+	{
+		void* const mem = N::AllocPolicy::allocate(size, alignof(N));
+
+		try
+		{
+			return Ref(new (mem) N(std::forward<A>(args)...));
+		}
+		catch (...)
+		{
+			N::AllocPolicy::deallocate(mem, size, alignof(N));
+			throw;
+		}
+	}
+
+	void swap (Ref& a) noexcept
+	{
+		std::swap(node, a.node);
+	}
+
+	N* get (void) const
+	{
+		return node;
+	}
+
+	N* operator -> (void) const
+	{
+		return node;
+	}
+
+	N& operator * (void) const
+	{
+		return *node;
+	}
+
+	explicit operator bool (void) const
+	{
+		return node != nullptr;
+	}
+
+	//nobody else can see the node, so whoever holds this may change it
+	bool unique (void) const
+	{
+		return node && N::CountPolicy::load(node->refs) == 1;
+	}
+
+	friend bool operator == (const Ref& a, const Ref& b)
+	{
+		return a.node == b.node;
+	}
+
+	friend bool operator != (const Ref& a, const Ref& b)
+	{
+		return a.node != b.node;
+	}
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef RING_H
+#define RING_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//bounded queue between exactly one pushing thread and one popping thread, no locks
+//each side owns one index and only reads the other's, the indexes count up forever
+//and wrap into a power of two sized array
+//
+//the sides can block on each other with waitReads and waitWrites, which sleep
+//until the other side has moved since the count they were given
+template <typename T>
+class Ring
+{
+	//keeps the two indexes off each other's cache lines
+	static constexpr size_t line = 64;
+
+	std::vector<std::optional<T>> slots;
+	const size_t mask;
+
+	alignas(line) std::atomic<size_t> head; //next slot to pop, written by the consumer
+	size_t tailSeen;                        //consumer's last look at tail
+	std::atomic<bool> consumerAsleep;
+
+	alignas(line) std::atomic<size_t> tail; //next slot to push, written by the producer
+	size_t headSeen;                        //producer's last look at head
+	std::atomic<bool> producerAsleep;
+
+	//only wakes the other side when it said it was going to sleep, and only once, 
+	//so a side that keeps going while the other is waiting to be scheduled doesn't make a call each time 
+	//the fence orders our index store before reading their flag, the same as their flag before their index
+	static void wake (std::atomic<size_t>& index, std::atomic<bool>& asleep)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(asleep.load(std::memory_order_relaxed) && asleep.exchange(false))
+			index.notify_one();
+	}
+
+	static void sleep (const std::atomic<size_t>& index, std::atomic<bool>& asleep, const size_t seen)
+	{
+		asleep.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		index.wait(seen, std::memory_order_acquire);
+	}
+
+	public:
+
+	explicit Ring (const size_t n)
+		: slots(std::bit_ceil(n ? n : 1)), mask(slots.size() - 1)
+		, head(0), tailSeen(0), consumerAsleep(false), tail(0), headSeen(0), producerAsleep(false)
+	{}
+
+	Ring (const Ring&) = delete;
+
+	size_t capacity (void) const
+	{
+		return slots.size();
+	}
+
+	//producer only, false when full, a moves only when it goes in
+	bool push (T& a)
+	{
+		const size_t t = tail.load(std::memory_order_relaxed);
+
+		if(t - headSeen == slots.size())
+		{
+			headSeen = head.load(std::memory_order_acquire);
+			if(t - headSeen == slots.size()) return false;
+		}
+
+		slots[t & mask].emplace(std::move(a));
+		tail.store(t + 1, std::memory_order_release);
+		wake(tail, consumerAsleep);
+
+		return true;
+	}
+
+	//consumer only, empty when there is nothing to take
+	std::optional<T> pop (void)
+	{
+		const size_t h = head.load(std::memory_order_relaxed);
+
+		if(h == tailSeen)
+		{
+			tailSeen = tail.load(std::memory_order_acquire);
+			if(h == tailSeen) return std::nullopt;
+		}
+
+		std::optional<T> out(std::move(slots[h & mask]));
+		slots[h & mask].reset();
+
+		head.store(h + 1, std::memory_order_release);
+		wake(head, producerAsleep);
+
+		return out;
+	}
+
+	//how many values have been popped and pushed so far, to hand to the waits
+	size_t reads (void) const
+	{
+		return head.load(std::memory_order_acquire);
+	}
+
+	size_t writes (void) const
+	{
+		return tail.load(std::memory_order_acquire);
+	}
+
+	void waitReads (const size_t seen)
+	{
+		sleep(head, producerAsleep, seen);
+	}
+
+	void waitWrites (const size_t seen)
+	{
+		sleep(tail, consumerAsleep, seen);
+	}
+};
+
+#endif
@@ -3,83 +3,357 @@
 
 #include "list.h" 
 #include "utility.h"
+#include "pool.h"
+#include <algorithm>
 #include <future>
+#include <vector>
 
 int count = 0;
 
+//checks the list is in the order mergeSort would leave it
 template <typename T, typename F = Ord<T>>
 bool sorted (const List<T> l, const F compare = ordOverload)
 {
-	if(l.length() < 2)
-		return true;
+	for(List<T> rest = l; rest.length() > 1; rest = rest.pop())
+		if(compare(rest.peek(), rest.pop().peek()))
+			return false;
+
+	return true;
+}
 
-	if( !compare( l.pop().peek(), l.peek()))
-		return false; 
+//merges two ordered lists, one comparison per element, ties keep a first 
+//whatever is left of the longer list is shared rather than copied 
+template <typename T, typename F = Ord<T>>
+List<T> mergeOrdered (List<T> a, List<T> b, const F compare = ordOverload)
+{
+	ListBuilder<T> out;
 
-	return sorted(l.pop(), compare);
+	while(a && b)
+	{
+		if(compare(a.peek(), b.peek()))
+		{
+			out.append(b.peek());
+			b = b.pop();
+		}
+		else
+		{
+			out.append(a.peek());
+			a = a.pop();
+		}
+	}
+
+	return out.freeze(a ? a : b);
 }
 
-template <typename T> 
-List<List<T>> shuffleSplit (const List<T> l, const List<T> larger = List<T>(nullptr), const List<T> smaller = List<T>(nullptr))
+//natural mergesort in the style of timsort 
+//one pass cuts the input into runs that are already in order, strictly descending
+//runs are flipped in place, short runs are topped up with a binary insertion sort
+//and runs are merged off a stack that keeps their lengths growing like fibonacci
+//merges switch to galloping when one side keeps winning, so sorted or nearly sorted
+//input is close to O(n) and interleaved input still costs one comparison per step
+
+//below this a run is padded out with insertion sort
+constexpr int sortMinRun = 32;
+
+//how many wins in a row before a merge starts galloping
+constexpr int sortMinGallop = 7;
+
+//first slot in [a, a + n) that x sorts after, counting equal elements
+//searches 1, 3, 7 ... from the front and then bisects the last gap
+template <typename T, typename L>
+int gallopRight (const T& x, const T* a, const int n, const L less)
 {
-	if(l.length() == 0)
-		return larger + List<List<T>>(smaller);
+	int lo = 0, hi = 1;
+	while(hi < n && !less(x, a[hi - 1]))
+	{
+		lo = hi;
+		hi = hi * 2 + 1;
+	}
 
-	if(l.length() == 1)
-		return larger + List<List<T>>(smaller + l.peek());
+	return std::upper_bound(a + lo, a + (hi < n ? hi : n), x, less) - a;
+}
+
+//first slot in [a, a + n) that x sorts before, counting equal elements
+template <typename T, typename L>
+int gallopLeft (const T& x, const T* a, const int n, const L less)
+{
+	int lo = 0, hi = 1;
+	while(hi < n && less(a[hi - 1], x))
+	{
+		lo = hi;
+		hi = hi * 2 + 1;
+	}
 
-	return shuffleSplit (l.pop(), l.peek() + smaller, larger);
+	return std::lower_bound(a + lo, a + (hi < n ? hi : n), x, less) - a;
 }
 
-template <typename T, typename F = Ord<T>>
-List<T> mergeOrdered (const List<T> a, const List<T> b, const F compare = ordOverload)
+//merges the neighbouring runs [a, a + n) and [a + n, a + n + m) in place
+//only the part of the left run that actually moves goes through tmp
+template <typename T, typename L>
+void mergeRuns (T* a, int n, int m, std::vector<T>& tmp, int& minGallop, const L less)
+{
+	T* b = a + n;
+
+	//the front of a that is below all of b and the back of b that is above all of a stay put
+	const int skip = gallopRight(*b, a, n, less);
+	a += skip;
+	n -= skip;
+
+	if(n == 0) return;
+
+	m = gallopLeft(a[n - 1], b, m, less);
+
+	if(m == 0) return;
+
+	tmp.clear();
+	tmp.insert(tmp.end(), std::make_move_iterator(a), std::make_move_iterator(a + n));
+
+	T* out = a;
+	int i = 0, j = 0;
+
+	while(i < n && j < m)
+	{
+		int winsA = 0, winsB = 0;
+
+		//one element at a time until a side wins often enough to gallop
+		while(i < n && j < m && winsA < minGallop && winsB < minGallop)
+		{
+			if(less(b[j], tmp[i]))
+			{
+				*out++ = std::move(b[j++]);
+				winsB++;
+				winsA = 0;
+			}
+			else
+			{
+				*out++ = std::move(tmp[i++]);
+				winsA++;
+				winsB = 0;
+			}
+		}
+
+		//jump over whole stretches of one side while the jumps stay long
+		while(i < n && j < m)
+		{
+			const int runA = gallopRight(b[j], tmp.data() + i, n - i, less);
+			out = std::move(tmp.begin() + i, tmp.begin() + i + runA, out);
+			i += runA;
+
+			if(i == n) break;
+
+			const int runB = gallopLeft(tmp[i], b + j, m - j, less);
+			out = std::move(b + j, b + j + runB, out);
+			j += runB;
+
+			if(j == m) break;
+
+			if(runA < sortMinGallop && runB < sortMinGallop)
+			{
+				minGallop++;
+				break;
+			}
+
+			if(minGallop > 1) minGallop--;
+		}
+	}
+
+	//what is left of b is already where it belongs
+	std::move(tmp.begin() + i, tmp.begin() + n, out);
+}
+
+//how short a run may be, something near sortMinRun that splits n into a power of two
+//or slightly fewer runs so the final merges stay balanced
+inline int sortRunLength (int n)
+{
+	int odd = 0;
+	while(n >= sortMinRun * 2)
+	{
+		odd |= n & 1;
+		n >>= 1;
+	}
+
+	return n + odd;
+}
+
+//stable sort of [a, a + n), returns false if it was already in order
+template <typename T, typename L>
+bool naturalSort (T* a, const int n, const L less)
 {
-	if(a.length() == 0 || b.length() == 0)
-		return a + b;
+	if(n < 2) return true;
+
+	const int minRun = sortRunLength(n);
+
+	std::vector<T> tmp;
+	std::vector<std::pair<int, int>> runs; //start and length
+	int minGallop = sortMinGallop;
+
+	const auto merge = [&](const int k){
+		mergeRuns(a + runs[k].first, runs[k].second, runs[k + 1].second, tmp, minGallop, less);
+		runs[k].second += runs[k + 1].second;
+		runs.erase(runs.begin() + k + 1);
+	};
+
+	for(int start = 0; start < n;)
+	{
+		int end = start + 1;
+		bool flipped = false;
+
+		if(end < n && less(a[end], a[start]))
+		{
+			//strictly descending, so flipping it can't reorder equal elements
+			while(end < n && less(a[end], a[end - 1])) end++;
+			std::reverse(a + start, a + end);
+			flipped = true;
+		}
+		else
+			while(end < n && !less(a[end], a[end - 1])) end++;
+
+		//one run covers everything, a flipped one is sorted now but no longer what came in
+		if(start == 0 && end == n)
+			return flipped;
+
+		//top short runs up with a binary insertion sort
+		const int full = std::min(n, start + minRun);
+		for(; end < full; end++)
+		{
+			T x = std::move(a[end]);
+			T* const at = std::upper_bound(a + start, a + end, x, less);
+
+			std::move_backward(at, a + end, a + end + 1);
+			*at = std::move(x);
+		}
 
-	const auto c = [&](const auto first, const auto second){ return compare(first.peek(), second.peek());};
+		runs.emplace_back(start, end - start);
+		start = end;
 
-	const List<T> larger =  ::max(a,b,c);
-	const List<T> smaller = ::min(a,b,c);
+		//keep the stack lengths growing faster than fibonacci from the top down
+		while(runs.size() > 1)
+		{
+			const int k = runs.size() - 2;
+			const auto len = [&](const int i){ return runs[i].second;};
 
-	return smaller.peek() + mergeOrdered( smaller.pop(), larger, compare);
+			if(k > 0 && len(k - 1) <= len(k) + len(k + 1))
+				merge(len(k - 1) < len(k + 1) ? k - 1 : k);
+			else if(len(k) <= len(k + 1))
+				merge(k);
+			else
+				break;
+		}
+	}
+
+	while(runs.size() > 1)
+		merge(runs.size() - 2);
+
+	return true;
 }
 
+//copies the list out once, sorts it with naturalSort and builds it back
+//a list that was already in order comes back as it is
 template <typename T>
 List<T> mergeSort (const List<T> l, const Ord<T> compare)
 {
-	//should just remove this because its O(n) and wastes time 
-	if(sorted(l, compare))
-		return l; 
+	if(l.length() < 2)
+		return l;
+
+	const auto less = [compare](const T& a, const T& b){ return compare(b, a);};
+
+	std::vector<T> a; 
+	a.reserve(l.length());
+	l.foldr([&](const T& x){ a.push_back(x);});
+
+	if(!naturalSort(a.data(), a.size(), less))
+		return l;
+
+	ListBuilder<T> out;
+	for(const T& x : a) out.append(x);
+
+	return out.freeze();
+}
+
+//parallel mergesort, the list is copied into a buffer once, halves are sorted 
+//on the pool down to a grain size and merged back with a parallel merge 
+//so neither the splitting nor the merging is a sequential bottleneck 
+
+//below this the sequential mergeSort wins outright 
+constexpr int parallelSortCutoff = 1 << 14;
+
+//pieces smaller than this are sorted or merged on one thread 
+constexpr int parallelSortGrain = 1 << 12;
+
+//merges sorted [a, a + n) and [b, b + m) into out, ties keep a first 
+template <typename T, typename L>
+void parallelMerge (T* a, const int n, T* b, const int m, T* out, const L less, Pool& pool)
+{
+	if(n + m <= parallelSortGrain)
+	{
+		std::merge(std::make_move_iterator(a), std::make_move_iterator(a + n), 
+				std::make_move_iterator(b), std::make_move_iterator(b + m), out, less);
+		return;
+	}
+
+	//split on the middle of the bigger side and find where it lands in the other 
+	int i, j;
+	if(n >= m)
+	{
+		i = n / 2;
+		j = std::lower_bound(b, b + m, a[i], less) - b;
+	}
+	else
+	{
+		j = m / 2;
+		i = std::upper_bound(a, a + n, b[j], less) - a;
+	}
 
-	const auto split  = shuffleSplit(l); 
-	const auto first  = mergeSort (split.peek(), compare);
-	const auto second = mergeSort (split.peek_back(), compare);
+	const auto left = pool.fork([=, &pool](){ parallelMerge(a, i, b, j, out, less, pool);});
+	parallelMerge(a + i, n - i, b + j, m - j, out + i + j, less, pool);
+	pool.join(left);
+}
 
-	/*
-	auto first = std::async(std::launch::async, 
-			[&](){return mergeSort(peek(split), compare);});
+//sorts [a, a + n) using b as scratch, the result ends up in b when flip is set 
+template <typename T, typename L>
+void parallelSortRange (T* a, T* b, const int n, const bool flip, const L less, Pool& pool)
+{
+	if(n <= parallelSortGrain)
+	{
+		naturalSort(a, n, less);
+		if(flip) std::move(a, a + n, b);
+		return;
+	}
 
-	auto second = std::async(std::launch::async, 
-			[&](){return mergeSort(peek_back(split), compare);});
-			*/
+	const int half = n / 2;
 
-	return mergeOrdered(first,second, compare);
+	const auto left = pool.fork([=, &pool](){ parallelSortRange(a, b, half, !flip, less, pool);});
+	parallelSortRange(a + half, b + half, n - half, !flip, less, pool);
+	pool.join(left);
+
+	//the halves sit in whichever buffer we are not merging into 
+	T* const from = flip ? a : b;
+	T* const to   = flip ? b : a;
+
+	parallelMerge(from, half, from + half, n - half, to, less, pool);
 }
 
-//we would have checks during debug, but then trust during release?
-//a lazy sorted list would return the 1st biggest and then second biggest ect 
-//would a lazy sorted list even be more efficient? 
-//assert that sorted, or actually construct mergesort? 
-/*
 template <typename T>
-struct SortedList<T> : public List<T>
+List<T> mergeSort (const List<T> l, const Parallel p, const Ord<T> compare = ordOverload)
 {
-	public:
-	*/
-	
-	
+	if(l.length() < parallelSortCutoff || p.pool.size() < 2)
+		return mergeSort(l, compare);
+
+	const auto less = [compare](const T& a, const T& b){ return compare(b, a);};
+
+	std::vector<T> a; 
+	a.reserve(l.length());
+	l.foldr([&](const T& x){ a.push_back(x);});
+
+	std::vector<T> b(a);
+	parallelSortRange(a.data(), b.data(), a.size(), false, less, p.pool);
+
+	ListBuilder<T> out;
+	for(const T& x : a) out.append(x);
+
+	return out.freeze();
+}
 
+//a lazy sorted list that hands out the smallest first is Sorted() in transformers.h, backed by heap.h
 
 #endif
-	
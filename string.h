@@ -24,7 +24,7 @@ class String : public List<char>
 		if(*str)
 			return *str + strList(str +1);
 
-		return List<char>(nullptr);
+		return List<char>();
 	}
 
 public:
@@ -0,0 +1,41 @@
+//g++ -std=c++20 -O2 tests/arena.cpp -o arena && ./arena
+#include "../arena.h"
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+
+bool aligned (const void* const p, const size_t align)
+{
+	return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+int main (void)
+{
+	{
+		const Region r;
+
+		//odd sizes in between push the offset off every boundary
+		for(int i = 0; i < 100000; i++)
+		{
+			const size_t align = size_t(1) << (i % 7);
+			void* const p = ArenaAlloc::allocate(i % 13 + 1, align);
+			assert(aligned(p, align));
+		}
+
+		//bigger than a block, gets a block of its own
+		assert(aligned(ArenaAlloc::allocate(1 << 20, 64), 64));
+		assert(aligned(ArenaAlloc::allocate(3, 1), 1));
+		assert(aligned(ArenaAlloc::allocate(16, 16), 16));
+		assert(aligned(ArenaAlloc::allocate(32, 32), 32));
+	}
+
+	{
+		const Region r;
+
+		//the first allocations of a fresh block, straight after the header
+		assert(aligned(ArenaAlloc::allocate(16, 16), 16));
+		assert(aligned(ArenaAlloc::allocate(32, 32), 32));
+	}
+
+	std::cout << "arena ok" << std::endl;
+}
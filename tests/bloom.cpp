@@ -0,0 +1,53 @@
+//g++ -std=c++20 -O2 tests/bloom.cpp -o bloom && ./bloom
+#include "../range.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+//fills a filter sized for n keys at fpr and counts how many keys it never saw it claims to have
+double measure (const size_t n, const double fpr)
+{
+	const double ln2 = std::log(2.0);
+	const size_t bytes = size_t(std::ceil(n * -std::log(fpr) / (ln2 * ln2) / 8));
+
+	BloomFilter bloom(bytes, fpr);
+	const std::hash<uint64_t> hash;
+
+	for(uint64_t i = 0; i < n; i++)
+		bloom.insert(hash(i));
+
+	//everything that went in is remembered
+	for(uint64_t i = 0; i < n; i++)
+		assert(bloom.contains(hash(i)));
+
+	size_t wrong = 0;
+	const size_t tries = 1000000;
+	for(uint64_t i = 0; i < tries; i++)
+		wrong += bloom.contains(hash(n + i));
+
+	return double(wrong) / tries;
+}
+
+int main (void)
+{
+	for(const double fpr : {0.1, 0.01, 0.001})
+	{
+		const double rate = measure(1000000, fpr);
+		std::cout << "fpr " << fpr << " measured " << rate << std::endl;
+
+		assert(rate < fpr * 1.2);
+	}
+
+	//n different keys through UniqueApprox sized for n, the dropped ones are the false positives
+	const int n = 200000;
+	const double ln2 = std::log(2.0);
+	const size_t bytes = size_t(std::ceil(n * -std::log(0.01) / (ln2 * ln2) / 8));
+
+	const int kept = int((Integers(0, n - 1) | UniqueApprox(bytes, 0.01) | Length()).eval());
+	std::cout << "UniqueApprox dropped " << double(n - kept) / n << std::endl;
+	assert(n - kept < n * 0.01);
+
+	assert((Integers(0, 99) | Map([](const int x){ return x % 10;}) | UniqueApprox(1024) | Length()).eval() == 10);
+
+	std::cout << "bloom ok" << std::endl;
+}
@@ -0,0 +1,159 @@
+//g++ -std=c++20 -O2 tests/hash.cpp -o hash && ./hash
+#include "../range.h"
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+//every key lands in one of 7 hashes, so collision nodes get built and taken apart
+struct Bad
+{
+	size_t operator () (const int x) const
+	{
+		return x % 7;
+	}
+};
+
+struct alignas(32) Wide
+{
+	int x;
+
+	bool operator == (const Wide& a) const
+	{
+		return x == a.x;
+	}
+};
+
+struct WideHash
+{
+	size_t operator () (const Wide& a) const
+	{
+		return std::hash<int>()(a.x);
+	}
+};
+
+//random sets and removes checked against std::map, older versions have to stay as they were
+template <typename M>
+void maps (std::mt19937& rng)
+{
+	M m;
+	std::map<int, int> want;
+	std::vector<std::pair<M, std::map<int, int>>> history;
+
+	for(int i = 0; i < 60000; i++)
+	{
+		const int k = rng() % 5000;
+
+		if(rng() % 4)
+		{
+			const int v = rng();
+			m = m.set(k, v);
+			want[k] = v;
+		}
+		else
+		{
+			m = m.remove(k);
+			want.erase(k);
+		}
+
+		assert(m.length() == int(want.size()));
+		if(i % 5000 == 0) history.push_back({m, want});
+	}
+
+	for(const auto& [old, was] : history)
+	{
+		for(int k = 0; k < 5000; k++)
+		{
+			const std::optional<int> v = old.get(k);
+			assert(v.has_value() == bool(was.count(k)));
+			if(v) assert(*v == was.at(k));
+		}
+
+		assert((Range(old) | Length()).eval() == was.size());
+	}
+}
+
+int main (void)
+{
+	std::mt19937 rng(6);
+
+	maps<HashMap<int, int>>(rng);
+
+	{
+		const Region r;
+		maps<HashMap<int, int, std::hash<int>, ArenaAlloc, LocalCount>>(rng);
+	}
+
+	for(int pass = 0; pass < 2; pass++)
+	{
+		HashSet<int, Bad> s;
+		std::set<int> want;
+
+		for(int i = 0; i < 4000; i++)
+		{
+			const int k = rng() % 300;
+
+			if(rng() % 3)
+			{
+				s = s.push(k);
+				want.insert(k);
+			}
+			else
+			{
+				s = s.remove(k);
+				want.erase(k);
+			}
+
+			assert(s.length() == int(want.size()));
+		}
+
+		for(int k = 0; k < 300; k++)
+			assert(s.contains(k) == bool(want.count(k)));
+
+		std::set<int> seen;
+		eval(Range(s) | Map([&](const int k){ seen.insert(k);}));
+		assert(seen == want);
+	}
+
+	//entries more aligned than the node header, built with -fsanitize=alignment a slot
+	//in the wrong place shows up here
+	{
+		HashSet<Wide, WideHash> s;
+		for(int i = 0; i < 1000; i++) s = s.push(Wide{i});
+
+		for(int i = 0; i < 1000; i++) assert(s.contains(Wide{i}));
+		assert(s.length() == 1000 && !s.contains(Wide{1000}));
+	}
+
+	{
+		HashSetBuilder<std::string> b;
+		for(int i = 0; i < 100000; i++) b.push(std::to_string(i % 70000));
+
+		const HashSet<std::string> s = b.freeze();
+		assert(s.length() == 70000 && s.contains("69999") && !s.contains("70000"));
+
+		//writing through a builder made from a set leaves the set alone
+		HashSetBuilder<std::string> more(s);
+		more.push("x");
+		more.remove("5");
+
+		const HashSet<std::string> t = more.freeze();
+		assert(s.contains("5") && !s.contains("x") && s.length() == 70000);
+		assert(t.contains("x") && !t.contains("5") && t.length() == 70000);
+	}
+
+	{
+		HashMapBuilder<int, int> b;
+		for(int i = 0; i < 1000000; i++) b.set(i, i);
+
+		const HashMap<int, int> big = b.freeze();
+		for(int i = 0; i < 1000000; i += 997) assert(*big.get(i) == i);
+
+		for(int i = 0; i < 1000000; i++) b.remove(i);
+		assert(b.length() == 0 && big.length() == 1000000 && *big.get(5) == 5);
+	}
+
+	std::cout << "hash ok" << std::endl;
+}
@@ -0,0 +1,26 @@
+//g++ -std=c++20 -O2 tests/length.cpp -o length && ./length
+#include "../range.h"
+#include <cassert>
+#include <climits>
+#include <iostream>
+
+int main (void)
+{
+	//exact hints, too many for an int
+	assert((Integers() | Length()).eval() == size_t(INT_MAX) + 1);
+	assert((Integers(INT_MIN, INT_MAX) | Length()).eval() == size_t(1) << 32);
+	assert((Integers(INT_MAX, INT_MIN) | Length()).eval() == size_t(1) << 32);
+	assert((Integers() | Skip(5) | Length()).eval() == size_t(INT_MAX) - 4);
+
+	assert((Integers(-5, 5) | Length()).eval() == 11);
+	assert((Integers(3, 3) | Length()).eval() == 1);
+
+	//no hint, counted
+	assert((Integers(1, 100) | Filter([](const int x){ return x % 3 == 0;}) | Length()).eval() == 33);
+	assert((Range(List<int>()) | Length()).eval() == 0);
+
+	//counts past INT_MAX, every value of Integers() matches
+	assert((Integers() | CountIf([](const int x){ return x >= 0;})).eval() == size_t(INT_MAX) + 1);
+
+	std::cout << "length ok" << std::endl;
+}
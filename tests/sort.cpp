@@ -0,0 +1,63 @@
+//g++ -std=c++20 -O2 -pthread tests/sort.cpp -o sort && ./sort
+#include "../sort.h"
+#include "../range.h"
+#include <cassert>
+#include <iostream>
+
+template <typename T>
+List<T> fromVector (const std::vector<T>& v)
+{
+	ListBuilder<T> out;
+	for(const T& a : v) out.append(a);
+
+	return out.freeze();
+}
+
+template <typename T>
+void check (const std::vector<T>& in)
+{
+	std::vector<T> want(in);
+	std::stable_sort(want.begin(), want.end());
+
+	const List<T> l = fromVector(in);
+
+	assert(mergeSort(l, ordOverload) == fromVector(want));
+	assert((Range(l) | Sort() | CollectList()) == fromVector(want));
+	assert(mergeSort(l, Parallel()) == fromVector(want));
+}
+
+int main (void)
+{
+	check(std::vector<int>{5, 4, 3, 2, 1});
+	check(std::vector<int>{2, 1});
+	check(std::vector<int>{1});
+	check(std::vector<int>{});
+
+	std::vector<int> down, same, up, saw;
+	for(int i = 0; i < 100000; i++)
+	{
+		down.push_back(100000 - i);
+		same.push_back(7);
+		up.push_back(i);
+		saw.push_back(i % 1000);
+	}
+
+	check(down);
+	check(same);
+	check(up);
+	check(saw);
+
+	//stability, equal keys keep their order
+	std::vector<std::pair<int, int>> pairs;
+	for(int i = 0; i < 5000; i++) pairs.emplace_back(4 - i % 5, i);
+
+	const auto less = [](const std::pair<int, int>& a, const std::pair<int, int>& b){ return a.first < b.first;};
+	std::vector<std::pair<int, int>> sorted(pairs);
+	naturalSort(sorted.data(), sorted.size(), less);
+
+	std::vector<std::pair<int, int>> want(pairs);
+	std::stable_sort(want.begin(), want.end(), less);
+	assert(sorted == want);
+
+	std::cout << "sort ok" << std::endl;
+}
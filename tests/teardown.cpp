@@ -0,0 +1,96 @@
+//g++ -std=c++20 -O2 tests/teardown.cpp -o teardown && (ulimit -s 1024 && ./teardown)
+//drops long chains of every node type under a 1 MB stack, a destructor that recursed
+//once per node would overflow long before the end, pass a count to run smaller
+//the default 10^8 nodes needs a few GB, the structures are built and freed one at a time
+#include "../list.h"
+#include "../tree.h"
+#include "../heap.h"
+#include "../generators.h"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+
+template <typename Node>
+void lists (const int n)
+{
+	ListBuilder<int, Node> back;
+	for(int i = n / 2; i < n; i++) back.append(i);
+	const List<int, Node> tail = back.freeze();
+
+	{
+		//the front half goes away while something still holds the back half
+		ListBuilder<int, Node> front;
+		for(int i = 0; i < n / 2; i++) front.append(i);
+
+		const List<int, Node> l = front.freeze(tail);
+		assert(l.length() == n);
+	}
+
+	assert(tail.length() == n - n / 2);
+	assert(tail.peek() == n / 2);
+}
+
+//a left spine n deep, no balanced tree or heap ends up like this but nodes can be made that way
+template <typename Node>
+void spine (const int n)
+{
+	Ref<Node> head = nullptr;
+	Ref<Node> half = nullptr;
+
+	for(int i = 0; i < n; i++)
+	{
+		head = Ref<Node>::make(i, head);
+		if(i == n / 2) half = head;
+	}
+
+	head = nullptr;
+	assert(half->res == n / 2 && half.unique());
+}
+
+void file (const int n)
+{
+	FILE* const f = tmpfile();
+	assert(f);
+
+	for(int i = 0; i < n; i++) fputc('a', f);
+	rewind(f);
+
+	//the first stream keeps the whole chain alive until it goes out of scope
+	const LazyFileStream head = fileStream(f);
+
+	std::optional<LazyFileStream> s;
+	s.emplace(head);
+
+	int read = 0;
+	while(!s->end())
+	{
+		read++;
+		s.emplace(s->next());
+	}
+
+	assert(read == n);
+}
+
+int main (const int argc, const char** argv)
+{
+	const int n = argc > 1 ? atoi(argv[1]) : 100000000;
+
+	lists<ListNode<int>>(n);
+	std::cout << "List ok" << std::endl;
+
+	lists<ChunkNode<int, 4>>(n);
+	std::cout << "ChunkList ok" << std::endl;
+
+	file(n);
+	std::cout << "LazyFileStream ok" << std::endl;
+
+	spine<TreeNode<int>>(n);
+	std::cout << "TreeNode ok" << std::endl;
+
+	spine<HeapNode<int>>(n);
+	std::cout << "HeapNode ok" << std::endl;
+
+	std::cout << "teardown ok" << std::endl;
+}
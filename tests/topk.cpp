@@ -0,0 +1,40 @@
+//g++ -std=c++20 -O2 tests/topk.cpp -o topk && ./topk
+#include "../range.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main (void)
+{
+	std::mt19937 rng(3);
+	std::vector<int> v;
+	for(int i = 0; i < 10000; i++) v.push_back(rng() % 1000);
+
+	//closest to pivot first, a capturing lambda, with plenty of ties to keep in input order
+	//comparators say whether a goes after b, the way ordOverload is a > b
+	const int pivot = 500;
+	const auto further = [pivot](const int a, const int b){ return std::abs(a - pivot) > std::abs(b - pivot);};
+	const auto closer = [pivot](const int a, const int b){ return std::abs(a - pivot) < std::abs(b - pivot);};
+
+	for(const size_t k : {size_t(0), size_t(1), size_t(50), size_t(20000)})
+	{
+		std::vector<int> want(v);
+		std::stable_sort(want.begin(), want.end(), closer);
+		want.resize(std::min(k, want.size()));
+
+		ListBuilder<int> expect;
+		for(const int a : want) expect.append(a);
+
+		assert((Range(v) | TopK(k, further) | CollectList()) == expect.freeze());
+	}
+
+	std::vector<int> small(v);
+	std::stable_sort(small.begin(), small.end());
+
+	const List<int> top = Range(v) | TopK(3) | CollectList();
+	assert(top.length() == 3 && top[0] == small[0] && top[2] == small[2]);
+
+	std::cout << "topk ok" << std::endl;
+}
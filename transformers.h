@@ -1,8 +1,17 @@
 #pragma once 
 #include <tuple> 
 #include <type_traits>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include "generators.h"
 #include "collectors.h" 
+#include "sort.h"
+#include "heap.h"
+#include "batch.h"
+#include "pool.h"
+#include "ring.h"
 
 struct Take 
 {
@@ -37,6 +46,53 @@ class TakeInstance
 		return TakeInstance ( stream.next(), Take(quant - 1));
 	}
 
+	template <typename Block>
+	requires HasBlocks<S>
+	bool blocks (Block&& block) const
+	{
+		if(!quant) return true;
+
+		size_t left = quant;
+		bool stopped = false;
+
+		stream.blocks([&](const T* p, const size_t n){
+			const size_t m = std::min(n, left);
+			left -= m;
+
+			if(!block(p, m)) stopped = true;
+			return !stopped && left > 0;
+		});
+
+		return !stopped;
+	}
+
+	//at most quant, exactly that when upstream knows it has as many 
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		const auto hint = ::sizeHint(stream);
+
+		if(!hint)
+			return SizeHint{quant, false};
+
+		return SizeHint{std::min(hint->size, quant), hint->exact};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		if(!quant) return true;
+
+		size_t left = quant;
+		bool stopped = false;
+
+		pushAll(stream, [&](const auto&... a){
+			if(!sink(a...)) stopped = true;
+			return !stopped && --left > 0;
+		});
+
+		return !stopped;
+	}
+
 	TakeInstance (const S s, const Take t)
 		: quant(t.quant), stream(s)
 	{}
@@ -65,12 +121,13 @@ class SkipInstance
 
 	const S stream; 
 
-	S skip (const S s, const size_t q) const
+	S skip (const S s, size_t q) const
 	{
-		if(q == 0 || s.end())
-			return s; 
+		std::optional<S> i(s);
+		for(; q && !i->end(); q--)
+			i.emplace(i->next());
 
-		return skip (s.next(), q - 1);
+		return *i; 
 	}
 
 	public:
@@ -90,6 +147,25 @@ class SkipInstance
 		return SkipInstance( stream.next(), 0);
 	}
 
+	//the skipping already happened when this was made
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		return ::sizeHint(stream);
+	}
+
+	template <typename Block>
+	requires HasBlocks<S>
+	bool blocks (Block&& block) const
+	{
+		return stream.blocks(block);
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		return pushAll(stream, sink);
+	}
+
 	SkipInstance  (const S s, const size_t q)
 		: stream( skip(s, q))
 	{}
@@ -178,6 +254,25 @@ class MapInstance
 		return MapInstance( stream.next(), fun);
 	}
 
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		return ::sizeHint(stream);
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		return pushAll(stream, [&](const auto&... a){
+			if constexpr (std::is_void_v<Value>)
+			{
+				fun(a...);
+				return sink();
+			}
+			else
+				return sink(fun(a...));
+		});
+	}
+
 };
 
 
@@ -237,6 +332,495 @@ auto operator | (Stream left, const Map<F>& right) -> MapInstance<decltype( righ
 	//return MapInstance<typename Stream::ValueType, Stream, F>(left, right);
 }
 
+//Map with f running on a pool, at most threads calls of it at once 
+//values come out in input order, and a window of the next threads values is always being worked on 
+//ahead of the furthest copy of the stream, so memory stays bounded however far it runs 
+template<typename F>
+struct ParallelMap 
+{
+	using FunctionType = F;
+	const F fun;
+	const size_t threads;
+	Pool& pool;
+
+	ParallelMap (const F f, const size_t t = 0, const Parallel p = Parallel())
+		: fun(f), threads(t ? t : p.pool.size()), pool(p.pool)
+	{}
+};
+
+template <typename Stream, typename F>
+class ParallelMapInstance 
+{
+	using V = typename Stream::ValueType;
+	using R = std::decay_t<std::invoke_result_t<const F&, const V&>>;
+
+	//one value, its job is started when the cell is made and joined the first time anyone asks 
+	struct Cell : public Counted<>
+	{
+		const size_t index;
+		const Pool::Job<R> job;
+		mutable std::once_flag joined;
+		mutable std::optional<R> res;
+		mutable Ref<Cell> tail; //written under the window's lock
+
+		Cell (const size_t i, const Pool::Job<R> j)
+			: index(i), job(j)
+		{}
+
+		~Cell (void)
+		{
+			Ref<Cell> n = std::move(tail);
+
+			while(n.unique())
+			{
+				Ref<Cell> t = std::move(n->tail);
+				n = std::move(t);
+			}
+		}
+	};
+
+	//the part of upstream nobody has started yet, shared by every copy of the stream 
+	struct Window : public Counted<>
+	{
+		std::mutex lock;
+		Pool& pool;
+		const F fun;
+		const size_t threads;
+
+		std::optional<Stream> upstream;
+		Ref<Cell> last;
+		size_t started;
+
+		Window (const Stream s, const ParallelMap<F>& m)
+			: pool(m.pool), fun(m.fun), threads(m.threads ? m.threads : 1), upstream(s), started(0)
+		{}
+
+		//starts jobs until through of them have been started, returns the first one it made
+		Ref<Cell> fill (const size_t through)
+		{
+			Ref<Cell> first;
+
+			for(; started < through && !upstream->end(); started++)
+			{
+				const auto job = pool.fork([f = fun, v = upstream->get()](){ return f(v);});
+				const Ref<Cell> c = Ref<Cell>::make(started, job);
+
+				if(last) last->tail = c;
+				if(!first) first = c;
+
+				last = c;
+				upstream.emplace(upstream->next());
+			}
+
+			return first;
+		}
+
+		Ref<Cell> begin (void)
+		{
+			const std::lock_guard<std::mutex> guard(lock);
+			return fill(threads);
+		}
+
+		Ref<Cell> after (const Cell& c)
+		{
+			const std::lock_guard<std::mutex> guard(lock);
+			fill(c.index + 1 + threads);
+
+			return c.tail;
+		}
+	};
+
+	const Ref<Window> window; 
+	const Ref<Cell> cell; 
+
+	ParallelMapInstance (const Ref<Window> w, const Ref<Cell> c)
+		: window(w), cell(c)
+	{}
+
+	public:
+	using ValueType = R;
+	using FunctionType = F; 
+	using StreamType = Stream;
+
+	ParallelMapInstance (const Stream s, const ParallelMap<F>& m)
+		: window(Ref<Window>::make(s, m)), cell(window->begin())
+	{}
+
+	R get (void) const 
+	{
+		std::call_once(cell->joined, [&](){ cell->res.emplace(window->pool.join(cell->job));});
+		return *cell->res;
+	}
+
+	bool end (void) const 
+	{
+		return !cell; 
+	}
+
+	ParallelMapInstance next (void) const 
+	{
+		if(!cell) return *this;
+
+		return ParallelMapInstance(window, window->after(*cell));
+	}
+};
+
+template<typename Stream, typename F>
+ParallelMapInstance<Stream, F> operator | (Stream left, const ParallelMap<F>& right)
+{
+	return ParallelMapInstance<Stream, F>(left, right);
+}
+
+//ParallelMap that hands results out in the order they finish, so one slow call holds nothing up 
+//the order is fixed the first time a copy of the stream steps past a value, later copies see the same one 
+template<typename F>
+struct ParallelMapUnordered 
+{
+	using FunctionType = F;
+	const F fun;
+	const size_t threads;
+	Pool& pool;
+
+	ParallelMapUnordered (const F f, const size_t t = 0, const Parallel p = Parallel())
+		: fun(f), threads(t ? t : p.pool.size()), pool(p.pool)
+	{}
+};
+
+template <typename Stream, typename F>
+class ParallelMapUnorderedInstance 
+{
+	using V = typename Stream::ValueType;
+	using R = std::decay_t<std::invoke_result_t<const F&, const V&>>;
+
+	struct Cell : public Counted<>
+	{
+		const R res;
+		mutable std::optional<Ref<Cell>> tail; //empty until someone steps past, null at the end
+
+		Cell (const R r)
+			: res(r)
+		{}
+
+		~Cell (void)
+		{
+			Ref<Cell> n = tail ? std::move(*tail) : nullptr;
+
+			while(n.unique() && n->tail)
+			{
+				Ref<Cell> t = std::move(*n->tail);
+				n = std::move(t);
+			}
+		}
+	};
+
+	//finished calls, workers add to it and whoever steps forward takes from it
+	struct Done 
+	{
+		std::mutex lock;
+		std::deque<std::pair<std::optional<R>, std::exception_ptr>> results;
+	};
+
+	struct Window : public Counted<>
+	{
+		std::mutex lock;
+		Pool& pool;
+		const F fun;
+		const size_t threads;
+
+		std::optional<Stream> upstream;
+		const std::shared_ptr<Done> done;
+		size_t running;
+
+		Window (const Stream s, const ParallelMapUnordered<F>& m)
+			: pool(m.pool), fun(m.fun), threads(m.threads ? m.threads : 1), upstream(s)
+			, done(std::make_shared<Done>()), running(0)
+		{}
+
+		void fill (void)
+		{
+			for(; running < threads && !upstream->end(); running++)
+			{
+				pool.fork([d = done, f = fun, v = upstream->get()](){
+					std::pair<std::optional<R>, std::exception_ptr> out;
+
+					try
+					{
+						out.first.emplace(f(v));
+					}
+					catch (...)
+					{
+						out.second = std::current_exception();
+					}
+
+					const std::lock_guard<std::mutex> guard(d->lock);
+					d->results.push_back(std::move(out));
+				});
+
+				upstream.emplace(upstream->next());
+			}
+		}
+
+		//the next call to finish, null once upstream is used up, the caller holds lock
+		Ref<Cell> take (void)
+		{
+			fill();
+
+			if(!running) return nullptr;
+
+			while(true)
+			{
+				std::optional<std::pair<std::optional<R>, std::exception_ptr>> out;
+
+				{
+					const std::lock_guard<std::mutex> guard(done->lock);
+					if(!done->results.empty())
+					{
+						out.emplace(std::move(done->results.front()));
+						done->results.pop_front();
+					}
+				}
+
+				if(!out)
+				{
+					if(!pool.help()) std::this_thread::yield();
+					continue;
+				}
+
+				running--;
+				fill();
+
+				if(out->second) std::rethrow_exception(out->second);
+
+				return Ref<Cell>::make(std::move(*out->first));
+			}
+		}
+
+		Ref<Cell> begin (void)
+		{
+			const std::lock_guard<std::mutex> guard(lock);
+			return take();
+		}
+
+		//the lock also guards the tails, so two copies stepping forward at once agree 
+		Ref<Cell> after (const Cell& c)
+		{
+			const std::lock_guard<std::mutex> guard(lock);
+			if(!c.tail) c.tail = take();
+
+			return *c.tail;
+		}
+	};
+
+	const Ref<Window> window; 
+	const Ref<Cell> cell; 
+
+	ParallelMapUnorderedInstance (const Ref<Window> w, const Ref<Cell> c)
+		: window(w), cell(c)
+	{}
+
+	public:
+	using ValueType = R;
+	using FunctionType = F; 
+	using StreamType = Stream;
+
+	ParallelMapUnorderedInstance (const Stream s, const ParallelMapUnordered<F>& m)
+		: window(Ref<Window>::make(s, m)), cell(window->begin())
+	{}
+
+	R get (void) const 
+	{
+		return cell->res;
+	}
+
+	bool end (void) const 
+	{
+		return !cell; 
+	}
+
+	ParallelMapUnorderedInstance next (void) const 
+	{
+		if(!cell) return *this;
+
+		return ParallelMapUnorderedInstance(window, window->after(*cell));
+	}
+};
+
+template<typename Stream, typename F>
+ParallelMapUnorderedInstance<Stream, F> operator | (Stream left, const ParallelMapUnordered<F>& right)
+{
+	return ParallelMapUnorderedInstance<Stream, F>(left, right);
+}
+
+//runs everything upstream on a thread of its own, which stays up to size values ahead 
+//values cross over through a Ring and are memoised on this side, so copies of the stream agree 
+//when the last copy goes the producer is told to stop and joined, it notices between values, 
+//so a source stuck in a slow read is waited for 
+struct Prefetch 
+{
+	const size_t size; 
+
+	Prefetch (const size_t n = 64)
+		: size(n ? n : 1)
+	{}
+};
+
+template <typename Stream>
+class PrefetchInstance 
+{
+	using T = typename Stream::ValueType;
+
+	struct Feed : public Counted<AtomicCount>
+	{
+		Ring<std::optional<T>> ring; //empty optional marks the end
+		std::atomic<bool> stop;
+		std::exception_ptr error;    //set before the end goes in
+
+		std::mutex lock; //the consumer side, copies can step forward from different threads
+		bool ended;
+
+		std::thread producer;
+
+		Feed (const Stream s, const size_t n)
+			: ring(n), stop(false), ended(false), producer([this, s](){ run(s);})
+		{}
+
+		~Feed (void)
+		{
+			stop.store(true, std::memory_order_release);
+
+			//frees a slot in case the producer is waiting for one
+			ring.pop();
+			producer.join();
+		}
+
+		//producer side, false once the consumer has gone
+		bool send (std::optional<T> a)
+		{
+			while(true)
+			{
+				const size_t seen = ring.reads();
+
+				if(ring.push(a))
+					return !stop.load(std::memory_order_acquire);
+
+				if(stop.load(std::memory_order_acquire)) 
+					return false;
+
+				ring.waitReads(seen);
+			}
+		}
+
+		void run (const Stream s)
+		{
+			try
+			{
+				pushAll(s, [&](const T& a){ return send(a);});
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			send(std::nullopt);
+		}
+
+		//consumer side, the next value or empty at the end, the caller holds lock
+		std::optional<T> receive (void)
+		{
+			while(!ended)
+			{
+				const size_t seen = ring.writes();
+
+				if(auto a = ring.pop())
+				{
+					if(*a) return std::move(*a);
+					ended = true;
+				}
+				else
+					ring.waitWrites(seen);
+			}
+
+			if(error) std::rethrow_exception(error);
+
+			return std::nullopt;
+		}
+	};
+
+	struct Cell : public Counted<AtomicCount>
+	{
+		const T res;
+		mutable std::optional<Ref<Cell>> tail; //empty until someone steps past, null at the end
+
+		Cell (const T r)
+			: res(r)
+		{}
+
+		~Cell (void)
+		{
+			Ref<Cell> n = tail ? std::move(*tail) : nullptr;
+
+			while(n.unique() && n->tail)
+			{
+				Ref<Cell> t = std::move(*n->tail);
+				n = std::move(t);
+			}
+		}
+	};
+
+	const Ref<Feed> feed; 
+	const Ref<Cell> cell; 
+
+	PrefetchInstance (const Ref<Feed> f, const Ref<Cell> c)
+		: feed(f), cell(c)
+	{}
+
+	static Ref<Cell> take (Feed& f)
+	{
+		const auto a = f.receive();
+		return a ? Ref<Cell>::make(*a) : nullptr;
+	}
+
+	static Ref<Cell> first (Feed& f)
+	{
+		const std::lock_guard<std::mutex> guard(f.lock);
+		return take(f);
+	}
+
+	public:
+	using ValueType = T;
+	using StreamType = Stream;
+
+	PrefetchInstance (const Stream s, const Prefetch p)
+		: feed(Ref<Feed>::make(s, p.size)), cell(first(*feed))
+	{}
+
+	T get (void) const 
+	{
+		return cell->res;
+	}
+
+	bool end (void) const 
+	{
+		return !cell; 
+	}
+
+	PrefetchInstance next (void) const 
+	{
+		if(!cell) return *this;
+
+		const std::lock_guard<std::mutex> guard(feed->lock);
+		if(!cell->tail) cell->tail = take(*feed);
+
+		return PrefetchInstance(feed, *cell->tail);
+	}
+};
+
+template<typename S>
+PrefetchInstance<S> operator | (S left, const Prefetch& right)
+{
+	return PrefetchInstance<S>(left, right);
+}
+
 /*
 template<typename Stream, typename F >
 auto operator >> (Stream left, const Map<F>& right) ->  
@@ -303,6 +887,33 @@ class ZipInstance
 	{
 		return ZipInstance( istream.next(), pstream.next());
 	}
+
+	//two vectors or arrays side by side, block gets a pointer into each 
+	template <typename Block>
+	requires requires (const InputStream a, const ParamStream b) { a.span(); b.span(); }
+	bool blocks (Block&& block) const
+	{
+		const auto a = istream.span();
+		const auto b = pstream.span();
+		const size_t n = std::min(a.size(), b.size());
+
+		return !n || block(a.data(), b.data(), n);
+	}
+
+	//as long as the shorter side 
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		const auto a = ::sizeHint(istream);
+		const auto b = ::sizeHint(pstream);
+
+		if(a && b)
+			return SizeHint{std::min(a->size, b->size), a->exact && b->exact};
+
+		if(a && a->exact) return SizeHint{a->size, false};
+		if(b && b->exact) return SizeHint{b->size, false};
+
+		return std::nullopt;
+	}
 };
 
 template <typename InputStream, typename ParamStream>
@@ -440,10 +1051,11 @@ class FilterInstance
 
 	Stream nextStream (const Stream s) const 
 	{
-		if(s.end()) return s;
-		if(fun(s.get())) return s;
+		std::optional<Stream> i(s);
+		while(!i->end() && !fun(i->get()))
+			i.emplace(i->next());
 
-		return nextStream(s.next());
+		return *i;
 	}
 
 	public:
@@ -470,6 +1082,23 @@ class FilterInstance
 	{
 		return FilterInstance( stream.next(), fun);
 	}
+
+	//never more than upstream, maybe fewer 
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		const auto hint = ::sizeHint(stream);
+
+		if(!hint)
+			return std::nullopt;
+
+		return SizeHint{hint->size, false};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		return pushAll(stream, [&](const Value& a){ return !fun(a) || sink(a);});
+	}
 };
 
 template< typename Stream, typename F>
@@ -501,8 +1130,10 @@ class FoldInstance
 
 	Value streamEater ( const Stream s, const Value v) const
 	{
-		if(s.end()) return v;
-		return streamEater(s.next(), fun(s.get(), v));
+		std::optional<Value> acc(v);
+		pushAll(s, [&](const auto& a){ acc.emplace(fun(a, *acc)); return true;});
+
+		return *acc;
 	}
 
 
@@ -554,12 +1185,18 @@ template <typename Stream>
 class LengthInstance 
 {
 	const Stream stream; 
-	//some kind of static memoization would be nice desu 
 	
-	int streamEater (const Stream s, const int i = 0) const 
+	//a count, Integers() alone is one more value than an int holds
+	size_t streamEater (const Stream s) const 
 	{
-		if(s.end()) return i; 
-		return streamEater(s.next(), i + 1);
+		const auto hint = sizeHint(s);
+		if(hint && hint->exact)
+			return hint->size;
+
+		size_t i = 0;
+		pushAll(s, [&](const auto&...){ i++; return true;});
+
+		return i;
 	}
 
 	public: 
@@ -570,12 +1207,12 @@ class LengthInstance
 	{};
 
 	
-	int get (void) const 
+	size_t get (void) const 
 	{
 		return streamEater(stream); 
 	}
 
-	int eval (void) const 
+	size_t eval (void) const 
 	{
 		return get(); 
 	}
@@ -597,131 +1234,1014 @@ auto operator | (Stream left, const Length& right) -> LengthInstance<Stream>
 	return LengthInstance<Stream>(left);
 }
 
-struct Unique 
-{};
-
-template <typename Value, typename Stream>
-class UniqueInstance 
+//reductions over a whole stream, each op's reduce does the work 
+//arithmetic values from contiguous sources go a block at a time through the kernels in batch.h 
+//Integers ranges are worked out in closed form and everything else is pushed one value at a time 
+template <typename Stream, typename Op>
+class ReductionInstance 
 {
-
-	const Tree<Value> set; 
 	const Stream stream; 
+	const Op op;
 
-	Stream nextStream (const Stream s) const 
-	{
-		if(s.end()) return s;
-		if(!set.contains(s.get())) return s; 
-
-		return nextStream(s.next()); 
-	}
-
-	public:
-	using ValueType = Value; 
-	using StreamType = Stream; 
+	public: 
+	using StreamType = Stream;
+	using ValueType = decltype(std::declval<const Op&>().reduce(std::declval<const Stream&>()));
 
-	UniqueInstance (const Stream s, const Tree<Value> t = Tree<Value>())
-		: set(t), stream( nextStream(s)) 
+	ReductionInstance (const Stream s, const Op o)
+		: stream(s), op(o)
 	{}
 
-	Value get (void) const 
+	ValueType get (void) const 
 	{
-		return stream.get();
+		return op.reduce(stream); 
+	}
+
+	ValueType eval (void) const 
+	{
+		return get(); 
 	}
 
 	bool end (void) const 
 	{
-		return stream.end(); 
+		return false; 
 	}
 
-	UniqueInstance next (void) const 
+	ReductionInstance next (void) const 
 	{
-		return UniqueInstance( stream.next(), set.push( stream.get()));
+		return *this; 
 	}
 };
 
-template <typename Stream>
-auto operator | (Stream left, const Unique& right) -> UniqueInstance<typename Stream::ValueType, Stream>
-{
-	return UniqueInstance<typename Stream::ValueType, Stream>(left);
-}
-
-template <typename Stream>
-class FlattenInstance 
+//sum of the values, 0 for an empty stream 
+struct Sum 
 {
-	const Stream stream; 
-	const int skipCount;
-
-	Stream skipBlank (const Stream s)
+	template <typename S>
+	typename S::ValueType reduce (const S& s) const
 	{
-		if(s.end()) return s;
+		using T = typename S::ValueType;
 
-		if (s.get().end())
-			return s.next();
+		if constexpr (std::is_same_v<S, Integers>)
+		{
+			const auto b = s.bounds();
+			if(!b) return 0;
 
-		return s;
-	}
-
-	public:
-	using ValueType = typename Stream::ValueType::ValueType; 
-	using StreamType = Stream;
+			const long long n = std::abs((long long)b->second - b->first) + 1;
+			return T(((long long)b->first + b->second) * n / 2);
+		}
 
+		T sum{};
 
-	FlattenInstance( const Stream s, const int skip = 0)
-		: stream( skipBlank(s)), skipCount(skip)
-	{}
+		if constexpr (std::is_arithmetic_v<T>)
+			pushBlocks(s, 
+				[&](const T* p, const size_t n){ sum += blockSum(p, n); return true;},
+				[&](const T& a){ sum += a; return true;});
+		else
+			pushAll(s, [&](const T& a){ sum = sum + a; return true;});
 
-	ValueType get (void) const
-	{
-		return (stream.get() | Skip(skipCount)).get();
+		return sum;
 	}
+};
 
-	bool end (void) const
+//smallest and largest value by <, empty for an empty stream 
+struct MinMax 
+{
+	template <typename S>
+	std::optional<std::pair<typename S::ValueType, typename S::ValueType>> reduce (const S& s) const
 	{
-		return stream.end();
+		using T = typename S::ValueType;
+
+		if constexpr (std::is_same_v<S, Integers>)
+		{
+			const auto b = s.bounds();
+			if(!b) return std::nullopt;
+
+			return std::pair(std::min(b->first, b->second), std::max(b->first, b->second));
+		}
+		else if constexpr (std::is_arithmetic_v<T>)
+		{
+			T lo{}, hi{};
+			bool any = false;
+
+			const auto one = [&](const T& a){
+				if(!any) lo = hi = a;
+				any = true;
+
+				lo = a < lo ? a : lo;
+				hi = hi < a ? a : hi;
+				return true;
+			};
+
+			pushBlocks(s, [&](const T* p, const size_t n){
+				if(!any) lo = hi = p[0];
+				any = true;
+
+				blockMinMax(p, n, lo, hi);
+				return true;
+			}, one);
+
+			if(!any) return std::nullopt;
+
+			return std::pair(lo, hi);
+		}
+		else
+		{
+			std::optional<std::pair<T, T>> out;
+
+			pushAll(s, [&](const T& a){
+				if(!out) 
+					out.emplace(a, a);
+				else if(a < out->first) 
+					out.emplace(a, out->second);
+				else if(out->second < a)
+					out.emplace(out->first, a);
+
+				return true;
+			});
+
+			return out;
+		}
 	}
+};
 
-	FlattenInstance next (void) const
+struct Min 
+{
+	template <typename S>
+	std::optional<typename S::ValueType> reduce (const S& s) const
 	{
+		const auto m = MinMax().reduce(s);
+		if(!m) return std::nullopt;
 
-		if(skipCount + 1>= (stream.get() | Length()).eval()) return FlattenInstance(stream.next(),0);
-
-		return FlattenInstance(stream, skipCount + 1);
-	}	
+		return m->first;
+	}
 };
 
-struct Flatten 
+struct Max 
 {
-	Flatten (void)
-	{}
+	template <typename S>
+	std::optional<typename S::ValueType> reduce (const S& s) const
+	{
+		const auto m = MinMax().reduce(s);
+		if(!m) return std::nullopt;
+
+		return m->second;
+	}
 };
 
-template<typename S>
-FlattenInstance<S> operator | (S left, const Flatten& right)
+//how many values f keeps, Length of a Filter without building the Filter 
+template <typename F>
+struct CountIf 
 {
-	return FlattenInstance<S>(left);
-}
+	using FunctionType = F;
+	const F fun;
 
-struct Loop
-{};
+	CountIf (const F f)
+		: fun(f)
+	{}
 
-template <typename Value, typename Stream>
-class LoopInstance
-{
-	const Stream start;
-	const Stream stream;
+	template <typename S>
+	size_t reduce (const S& s) const
+	{
+		using T = typename S::ValueType;
+		size_t count = 0;
 
-	public:
-	using ValueType = Value;
-	using StreamType = Stream;
+		pushBlocks(s, 
+			[&](const T* p, const size_t n){ count += blockCount(p, n, fun); return true;},
+			[&](const T& a){ count += bool(fun(a)); return true;});
 
-	LoopInstance (const Stream st, const Stream s)
-		: start(st), stream(s)
-	{}
+		return count;
+	}
+};
 
-	Value get (void) const 
+//sum of products over a Zip of two streams 
+struct Dot 
+{
+	template <typename S>
+	auto reduce (const S& s) const
 	{
-		return stream.get();
-	}
+		using A = std::tuple_element_t<0, typename S::ValueType>;
+		using B = std::tuple_element_t<1, typename S::ValueType>;
+		using R = decltype(std::declval<A>() * std::declval<B>());
+
+		R sum{};
+
+		if constexpr (requires { s.blocks([](const A*, const B*, size_t){ return true;}); })
+			s.blocks([&](const A* a, const B* b, const size_t n){ sum += blockDot(a, b, n); return true;});
+		else
+			pushAll(s, [&](const typename S::ValueType& t){ sum += std::get<0>(t) * std::get<1>(t); return true;});
+
+		return sum;
+	}
+};
+
+template <typename Stream> 
+auto operator | (Stream left, const Sum& right) -> ReductionInstance<Stream, Sum> 
+{
+	return ReductionInstance<Stream, Sum>(left, right);
+}
+
+template <typename Stream> 
+auto operator | (Stream left, const MinMax& right) -> ReductionInstance<Stream, MinMax> 
+{
+	return ReductionInstance<Stream, MinMax>(left, right);
+}
+
+template <typename Stream> 
+auto operator | (Stream left, const Min& right) -> ReductionInstance<Stream, Min> 
+{
+	return ReductionInstance<Stream, Min>(left, right);
+}
+
+template <typename Stream> 
+auto operator | (Stream left, const Max& right) -> ReductionInstance<Stream, Max> 
+{
+	return ReductionInstance<Stream, Max>(left, right);
+}
+
+template <typename Stream, typename F> 
+auto operator | (Stream left, const CountIf<F>& right) -> ReductionInstance<Stream, CountIf<F>> 
+{
+	return ReductionInstance<Stream, CountIf<F>>(left, right);
+}
+
+template <typename Stream> 
+auto operator | (Stream left, const Dot& right) -> ReductionInstance<Stream, Dot> 
+{
+	return ReductionInstance<Stream, Dot>(left, right);
+}
+
+//below this many values a Reduce folds on one thread 
+constexpr size_t reduceGrain = 1 << 12;
+
+//Fold for an associative combine, identity has to leave anything it is combined with alone 
+//splittable streams are cut in half down to reduceGrain and the halves reduced on the pool 
+//the cuts only depend on the length and halves are always combined first then second, 
+//so the answer is the same on every run and the same as a left to right fold 
+template <typename F, typename V>
+struct Reduce 
+{
+	using FunctionType = F;
+	using ValueType = V;
+	const F fun; 
+	const V identity;
+	Pool& pool;
+
+	Reduce (const F f, const V v, const Parallel p = Parallel())
+		: fun(f), identity(v), pool(p.pool)
+	{}
+
+	template <typename S>
+	V fold (const S& s) const
+	{
+		std::optional<V> acc(identity);
+		pushAll(s, [&](const auto& a){ acc.emplace(fun(*acc, a)); return true;});
+
+		return *acc;
+	}
+
+	template <typename S>
+	V split (const S& s) const
+	{
+		const auto hint = s.sizeHint();
+		if(!hint || hint->size <= reduceGrain)
+			return fold(s);
+
+		const auto [a, b] = s.split();
+		const auto [x, y] = pool.both([&](){ return split(a);}, [&](){ return split(b);});
+
+		return fun(x, y);
+	}
+
+	template <typename S>
+	V reduce (const S& s) const
+	{
+		if constexpr (IsSplittable<S>)
+			if(pool.size() > 1) 
+				return split(s);
+
+		return fold(s);
+	}
+};
+
+template <typename Stream, typename F, typename V> 
+auto operator | (Stream left, const Reduce<F, V>& right) -> ReductionInstance<Stream, Reduce<F, V>> 
+{
+	return ReductionInstance<Stream, Reduce<F, V>>(left, right);
+}
+
+//Set is the seen set, void keeps a plain Tree of the values 
+//Unique(HashSet<int>()) hashes instead, which needs no ordering and is cheaper per element 
+//Unique(Tree<int, ordOverload, ArenaAlloc>()) keeps it in the thread's arena instead 
+template <typename Set = void>
+struct Unique 
+{
+	const Set set; 
+
+	Unique (const Set s)
+		: set(s)
+	{}
+};
+
+template <>
+struct Unique<void> 
+{};
+
+Unique() -> Unique<void>;
+
+//unique by key(value), only the first value with each key gets through 
+//the keys go in a HashSet unless another set is given 
+template <typename F, typename Set = void>
+struct UniqueBy 
+{
+	const F key; 
+	const Set set; 
+
+	UniqueBy (const F f, const Set s)
+		: key(f), set(s)
+	{}
+};
+
+template <typename F>
+struct UniqueBy<F, void> 
+{
+	const F key; 
+
+	UniqueBy (const F f)
+		: key(f)
+	{}
+};
+
+template <typename F>
+UniqueBy(F) -> UniqueBy<F, void>;
+
+template <typename Value, typename Stream, typename Set = Tree<Value>, typename Key = std::identity>
+class UniqueInstance 
+{
+
+	const Set set; 
+	const Key key; 
+	const Stream stream; 
+
+	Stream nextStream (const Stream s) const 
+	{
+		std::optional<Stream> i(s);
+		while(!i->end() && set.contains(key(i->get())))
+			i.emplace(i->next());
+
+		return *i; 
+	}
+
+	public:
+	using ValueType = Value; 
+	using StreamType = Stream; 
+
+	UniqueInstance (const Stream s, const Set t = Set(), const Key k = Key())
+		: set(t), key(k), stream( nextStream(s)) 
+	{}
+
+	Value get (void) const 
+	{
+		return stream.get();
+	}
+
+	bool end (void) const 
+	{
+		return stream.end(); 
+	}
+
+	UniqueInstance next (void) const 
+	{
+		return UniqueInstance( stream.next(), set.push( key(stream.get())), key);
+	}
+};
+
+template <typename Stream>
+auto operator | (Stream left, const Unique<void>& right) -> UniqueInstance<typename Stream::ValueType, Stream>
+{
+	return UniqueInstance<typename Stream::ValueType, Stream>(left);
+}
+
+template <typename Stream, typename Set>
+auto operator | (Stream left, const Unique<Set>& right) -> UniqueInstance<typename Stream::ValueType, Stream, Set>
+{
+	return UniqueInstance<typename Stream::ValueType, Stream, Set>(left, right.set);
+}
+
+template <typename Stream, typename F>
+auto operator | (Stream left, const UniqueBy<F, void>& right) 
+{
+	using Value = typename Stream::ValueType;
+	using Set = HashSet<std::decay_t<std::invoke_result_t<F, Value>>>;
+
+	return UniqueInstance<Value, Stream, Set, F>(left, Set(), right.key);
+}
+
+template <typename Stream, typename F, typename Set>
+auto operator | (Stream left, const UniqueBy<F, Set>& right) -> UniqueInstance<typename Stream::ValueType, Stream, Set, F>
+{
+	return UniqueInstance<typename Stream::ValueType, Stream, Set, F>(left, right.set, right.key);
+}
+
+//approximate unique in fixed memory, a bloom filter of bytes remembers what went by 
+//repeats never get through, a first sighting is wrongly dropped less than fpr of the time 
+//until the filter holds the number of keys its size is meant for, see BloomFilter in hash.h 
+struct UniqueApprox 
+{
+	const size_t bytes; 
+	const double fpr; 
+
+	UniqueApprox (const size_t b, const double f = 0.01)
+		: bytes(b), fpr(f)
+	{}
+};
+
+//the filter is written in place, so every step is worked out once and remembered 
+//in a chain shared by all copies of the stream, the same way LazyFileStream reads its file 
+template <typename Value, typename Stream>
+class UniqueApproxInstance 
+{
+	struct Filter : public Counted<>
+	{
+		BloomFilter bloom; 
+
+		Filter (const UniqueApprox a)
+			: bloom(a.bytes, a.fpr)
+		{}
+	};
+
+	struct Cell : public Counted<>
+	{
+		const Stream stream; //upstream, sitting on this step's value
+		mutable Ref<Cell> tail; 
+
+		Cell (const Stream s)
+			: stream(s)
+		{}
+
+		//long runs make long chains, unlink them one at a time instead of recursing 
+		~Cell (void)
+		{
+			Ref<Cell> n = std::move(tail);
+
+			while(n.unique())
+			{
+				Ref<Cell> t = std::move(n->tail);
+				n = std::move(t);
+			}
+		}
+	};
+
+	const Ref<Filter> filter; 
+	const Ref<Cell> cell; 
+
+	//the first value from s on the filter has not seen, which it now has
+	static Ref<Cell> skip (const Stream s, BloomFilter& bloom)
+	{
+		std::optional<Stream> i(s);
+		while(!i->end() && bloom.insert(std::hash<Value>()(i->get())))
+			i.emplace(i->next());
+
+		return Ref<Cell>::make(*i);
+	}
+
+	UniqueApproxInstance (const Ref<Filter> f, const Ref<Cell> c)
+		: filter(f), cell(c)
+	{}
+
+	public:
+	using ValueType = Value; 
+	using StreamType = Stream; 
+
+	UniqueApproxInstance (const Stream s, const UniqueApprox a)
+		: filter(Ref<Filter>::make(a)), cell(skip(s, filter->bloom))
+	{}
+
+	Value get (void) const 
+	{
+		return cell->stream.get();
+	}
+
+	bool end (void) const 
+	{
+		return cell->stream.end(); 
+	}
+
+	UniqueApproxInstance next (void) const 
+	{
+		if(end()) return *this; 
+
+		if(!cell->tail)
+			cell->tail = skip(cell->stream.next(), filter->bloom);
+
+		return UniqueApproxInstance(filter, cell->tail);
+	}
+};
+
+template <typename Stream>
+auto operator | (Stream left, const UniqueApprox& right) -> UniqueApproxInstance<typename Stream::ValueType, Stream>
+{
+	return UniqueApproxInstance<typename Stream::ValueType, Stream>(left, right);
+}
+
+//keeps a cursor into the inner stream it is partway through, so each value is O(1)
+//and each outer value is only asked for once 
+template <typename Stream>
+class FlattenInstance 
+{
+	using Inner = typename Stream::ValueType;
+
+	const Stream stream; //sits on the inner stream being read 
+	const std::optional<Inner> inner;
+
+	FlattenInstance (const Stream s, const std::optional<Inner> i)
+		: stream(s), inner(i)
+	{}
+
+	//moves on to the first inner stream that isn't empty
+	static FlattenInstance first (const Stream s)
+	{
+		std::optional<Stream> i(s);
+		for(; !i->end(); i.emplace(i->next()))
+		{
+			const Inner in = i->get();
+			if(!in.end())
+				return FlattenInstance(*i, in);
+		}
+
+		return FlattenInstance(*i, std::nullopt);
+	}
+
+	public:
+	using ValueType = typename Inner::ValueType; 
+	using StreamType = Stream;
+
+	FlattenInstance (const Stream s)
+		: FlattenInstance(first(s))
+	{}
+
+	ValueType get (void) const
+	{
+		return inner->get();
+	}
+
+	bool end (void) const
+	{
+		return !inner;
+	}
+
+	FlattenInstance next (void) const
+	{
+		if(!inner) return *this;
+
+		const Inner rest = inner->next();
+		if(!rest.end())
+			return FlattenInstance(stream, rest);
+
+		return first(stream.next());
+	}	
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		if(!inner) return true;
+		if(!pushAll(*inner, sink)) return false;
+
+		return pushAll(stream.next(), [&](const Inner& in){ return pushAll(in, sink);});
+	}
+};
+
+struct Flatten 
+{
+	Flatten (void)
+	{}
+};
+
+template<typename S>
+FlattenInstance<S> operator | (S left, const Flatten& right)
+{
+	return FlattenInstance<S>(left);
+}
+
+//maps every value to a stream and reads them one after another 
+template<typename F>
+struct FlatMap 
+{
+	const F fun;
+
+	FlatMap (const F f)
+		: fun(f)
+	{}
+};
+
+template<typename S, typename F>
+auto operator | (S left, const FlatMap<F>& right)
+{
+	return FlattenInstance(left | Map(right.fun));
+}
+
+//groups a stream into Batches of up to size values laid out next to each other
+//so BatchMap and BatchFilter can work on whole blocks in tight loops, Unchunk goes back 
+struct Chunk 
+{
+	const size_t size; 
+
+	Chunk (const size_t n)
+		: size(n ? n : 1)
+	{}
+};
+
+template <typename Stream>
+class ChunkInstance 
+{
+	using T = typename Stream::ValueType;
+
+	const size_t size;
+	const Stream rest; //everything after the batch
+	const Batch<T> batch;
+
+	ChunkInstance (const size_t n, const Stream r, const Batch<T> b)
+		: size(n), rest(r), batch(b)
+	{}
+
+	static ChunkInstance first (const Stream s, const size_t n)
+	{
+		std::vector<T> values; 
+		values.reserve(n);
+
+		std::optional<Stream> i(s);
+		for(; values.size() < n && !i->end(); i.emplace(i->next()))
+			values.push_back(i->get());
+
+		return ChunkInstance(n, *i, Batch<T>(std::move(values)));
+	}
+
+	public:
+	using ValueType = Batch<T>;
+	using StreamType = Stream;
+
+	ChunkInstance (const Stream s, const Chunk c)
+		: ChunkInstance(first(s, c.size))
+	{}
+
+	ValueType get (void) const
+	{
+		return batch;
+	}
+
+	bool end (void) const
+	{
+		return !batch;
+	}
+
+	ChunkInstance next (void) const
+	{
+		if(!batch) return *this;
+
+		return first(rest, size);
+	}
+
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		if(!batch) return SizeHint{0, true};
+
+		const auto hint = ::sizeHint(rest);
+		if(!hint) return std::nullopt;
+
+		return SizeHint{1 + (hint->size + size - 1) / size, hint->exact};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		if(!batch) return true;
+		if(!sink(batch)) return false;
+
+		std::vector<T> values; 
+		values.reserve(size);
+
+		const bool more = pushAll(rest, [&](const T& a){
+			values.push_back(a);
+			if(values.size() < size) return true;
+
+			const Batch<T> full(std::move(values));
+			values.clear();
+			values.reserve(size);
+
+			return sink(full);
+		});
+
+		return more && (values.empty() || sink(Batch<T>(std::move(values))));
+	}
+};
+
+template<typename S>
+ChunkInstance<S> operator | (S left, const Chunk& right)
+{
+	return ChunkInstance<S>(left, right);
+}
+
+struct Unchunk 
+{};
+
+template <typename Stream>
+class UnchunkInstance 
+{
+	using B = typename Stream::ValueType;
+
+	const Stream stream; //sits on the batch being read 
+	const B batch; 
+	const size_t i;
+
+	UnchunkInstance (const Stream s, const B b, const size_t n)
+		: stream(s), batch(b), i(n)
+	{}
+
+	//moves on to the first batch that isn't empty
+	static UnchunkInstance first (const Stream s)
+	{
+		std::optional<Stream> i(s);
+		for(; !i->end(); i.emplace(i->next()))
+		{
+			const B b = i->get();
+			if(b) return UnchunkInstance(*i, b, 0);
+		}
+
+		return UnchunkInstance(*i, B(), 0);
+	}
+
+	public:
+	using ValueType = typename B::DataType;
+	using StreamType = Stream;
+
+	UnchunkInstance (const Stream s)
+		: UnchunkInstance(first(s))
+	{}
+
+	ValueType get (void) const
+	{
+		return batch[i];
+	}
+
+	bool end (void) const
+	{
+		return !batch;
+	}
+
+	UnchunkInstance next (void) const
+	{
+		if(!batch) return *this;
+
+		if(i + 1 < batch.length())
+			return UnchunkInstance(stream, batch, i + 1);
+
+		return first(stream.next());
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		const auto all = [&](const B& b, const size_t from){
+			for(size_t n = from; n < b.length(); n++)
+				if(!sink(b[n])) return false;
+
+			return true;
+		};
+
+		if(!batch) return true;
+		if(!all(batch, i)) return false;
+
+		return pushAll(stream.next(), [&](const B& b){ return all(b, 0);});
+	}
+
+	template <typename Block>
+	bool blocks (Block&& block) const
+	{
+		if(!batch) return true;
+		if(!block(batch.begin() + i, batch.length() - i)) return false;
+
+		return pushAll(stream.next(), [&](const B& b){ return !b || block(b.begin(), b.length());});
+	}
+};
+
+template<typename S>
+UnchunkInstance<S> operator | (S left, const Unchunk& right)
+{
+	return UnchunkInstance<S>(left);
+}
+
+//Map over every value of every batch in one loop per batch
+template<typename F>
+struct BatchMap 
+{
+	using FunctionType = F;
+	const F fun;
+
+	BatchMap (const F f)
+		: fun(f)
+	{}
+};
+
+template <typename Stream, typename F>
+class BatchMapInstance 
+{
+	using T = typename Stream::ValueType::DataType;
+	using R = std::decay_t<std::invoke_result_t<F, const T&>>;
+
+	const Stream stream; 
+	const F fun;
+
+	public:
+	using ValueType = Batch<R>;
+	using FunctionType = F; 
+	using StreamType = Stream;
+
+	BatchMapInstance (const Stream s, const F f)
+		: stream(s), fun(f)
+	{}
+
+	static ValueType apply (const typename Stream::ValueType& b, const F& f)
+	{
+		std::vector<R> out; 
+
+		if constexpr (std::is_arithmetic_v<R>)
+		{
+			out.resize(b.length());
+			batchMap(b.begin(), b.length(), out.data(), f);
+		}
+		else
+		{
+			out.reserve(b.length());
+			for(const T& a : b) out.push_back(f(a));
+		}
+
+		return ValueType(std::move(out));
+	}
+
+	ValueType get (void) const
+	{
+		return apply(stream.get(), fun);
+	}
+
+	bool end (void) const
+	{
+		return stream.end();
+	}
+
+	BatchMapInstance next (void) const
+	{
+		return BatchMapInstance(stream.next(), fun);
+	}
+
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		return ::sizeHint(stream);
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		return pushAll(stream, [&](const typename Stream::ValueType& b){ return sink(apply(b, fun));});
+	}
+};
+
+template<typename S, typename F>
+BatchMapInstance<S, F> operator | (S left, const BatchMap<F>& right)
+{
+	return BatchMapInstance<S, F>(left, right.fun);
+}
+
+//Filter over every value of every batch, batches left empty are dropped 
+template<typename F>
+struct BatchFilter 
+{
+	using FunctionType = F;
+	const F fun;
+
+	BatchFilter (const F f)
+		: fun(f)
+	{}
+};
+
+template <typename Stream, typename F>
+class BatchFilterInstance 
+{
+	using B = typename Stream::ValueType;
+	using T = typename B::DataType;
+
+	const F fun;
+	const Stream stream; //sits on the batch the kept values came from 
+	const B batch; 
+
+	BatchFilterInstance (const F f, const Stream s, const B b)
+		: fun(f), stream(s), batch(b)
+	{}
+
+	static B apply (const B& b, const F& f)
+	{
+		std::vector<T> out; 
+
+		if constexpr (std::is_arithmetic_v<T>)
+		{
+			out.resize(b.length());
+			out.resize(batchFilter(b.begin(), b.length(), out.data(), f));
+		}
+		else
+		{
+			for(const T& a : b) 
+				if(f(a)) out.push_back(a);
+		}
+
+		return B(std::move(out));
+	}
+
+	static BatchFilterInstance first (const Stream s, const F f)
+	{
+		std::optional<Stream> i(s);
+		for(; !i->end(); i.emplace(i->next()))
+		{
+			const B kept = apply(i->get(), f);
+			if(kept) return BatchFilterInstance(f, *i, kept);
+		}
+
+		return BatchFilterInstance(f, *i, B());
+	}
+
+	public:
+	using ValueType = B;
+	using FunctionType = F; 
+	using StreamType = Stream;
+
+	BatchFilterInstance (const Stream s, const F f)
+		: BatchFilterInstance(first(s, f))
+	{}
+
+	ValueType get (void) const
+	{
+		return batch;
+	}
+
+	bool end (void) const
+	{
+		return !batch;
+	}
+
+	BatchFilterInstance next (void) const
+	{
+		if(!batch) return *this;
+
+		return first(stream.next(), fun);
+	}
+
+	//never more batches than upstream, maybe fewer 
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		const auto hint = ::sizeHint(stream);
+
+		if(!hint)
+			return std::nullopt;
+
+		return SizeHint{hint->size, false};
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		if(!batch) return true;
+		if(!sink(batch)) return false;
+
+		return pushAll(stream.next(), [&](const B& b){
+			const B kept = apply(b, fun);
+			return !kept || sink(kept);
+		});
+	}
+};
+
+template<typename S, typename F>
+BatchFilterInstance<S, F> operator | (S left, const BatchFilter<F>& right)
+{
+	return BatchFilterInstance<S, F>(left, right.fun);
+}
+
+struct Loop
+{};
+
+template <typename Value, typename Stream>
+class LoopInstance
+{
+	const Stream start;
+	const Stream stream;
+
+	public:
+	using ValueType = Value;
+	using StreamType = Stream;
+
+	LoopInstance (const Stream st, const Stream s)
+		: start(st), stream(s)
+	{}
+
+	Value get (void) const 
+	{
+		return stream.get();
+	}
 
 
 	bool end (void) const
@@ -742,5 +2262,233 @@ auto operator | (Stream left, const Loop& right) -> LoopInstance<typename Stream
 	return LoopInstance<typename Stream::ValueType, Stream>(left, left);
 }
 
+//sorts everything upstream as soon as it is piped in, then streams the result 
+//Sort(), Sort(compare), and either with Parallel() to sort on the pool 
+template <typename F = void>
+struct Sort 
+{
+	const F compare; 
+	const std::optional<Parallel> parallel;
+
+	Sort (const F f, const std::optional<Parallel> p = std::nullopt)
+		: compare(f), parallel(p)
+	{}
+};
+
+template <>
+struct Sort<void> 
+{
+	const std::optional<Parallel> parallel;
+
+	Sort (const std::optional<Parallel> p = std::nullopt)
+		: parallel(p)
+	{}
+};
+
+Sort() -> Sort<void>;
+Sort(Parallel) -> Sort<void>;
+
+template <typename Value>
+class SortInstance 
+{
+	const ListStream<Value> stream;
+
+	public:
+	using ValueType = Value; 
+
+	SortInstance (const ListStream<Value> s)
+		: stream(s)
+	{}
+
+	Value get (void) const 
+	{
+		return stream.get();
+	}
+
+	bool end (void) const 
+	{
+		return stream.end();
+	}
+
+	SortInstance next (void) const 
+	{
+		return SortInstance(stream.next());
+	}
+
+	std::optional<SizeHint> sizeHint (void) const
+	{
+		return stream.sizeHint();
+	}
+
+	template <typename Sink>
+	bool push (Sink& sink) const
+	{
+		return stream.push(sink);
+	}
+};
+
+template <typename Stream, typename F>
+auto operator | (Stream left, const Sort<F>& right) -> SortInstance<typename Stream::ValueType>
+{
+	using Value = typename Stream::ValueType;
+
+	const List<Value> in = left | CollectList();
+	const Ord<Value>* compare = nullptr;
+
+	if constexpr (std::is_void_v<F>) compare = ordOverload;
+	else                             compare = right.compare;
+
+	if(right.parallel)
+		return SortInstance<Value>(mergeSort(in, *right.parallel, compare));
+
+	return SortInstance<Value>(mergeSort(in, compare));
+}
+
+//lazy sort, heapifies everything upstream in O(n) as soon as it is piped in 
+//and then finds each next smallest element in O(log n) only when asked 
+//so Sorted() | Take(k) is O(n + k log n), equal elements come out in no particular order 
+//Sorted(Heap<int, descending>()) picks the order and allocator, anything already in it is merged in 
+template <typename HeapType = void>
+struct Sorted 
+{
+	const HeapType heap; 
+
+	Sorted (const HeapType h)
+		: heap(h)
+	{}
+};
+
+template <>
+struct Sorted<void> 
+{};
+
+Sorted() -> Sorted<void>;
+
+template <typename Value, typename HeapType>
+class SortedInstance 
+{
+	const HeapType heap; 
+
+	public:
+	using ValueType = Value; 
+
+	SortedInstance (const HeapType h)
+		: heap(h)
+	{}
+
+	Value get (void) const 
+	{
+		return heap.peek();
+	}
+
+	bool end (void) const 
+	{
+		return !heap;
+	}
+
+	SortedInstance next (void) const 
+	{
+		return SortedInstance(heap.pop());
+	}
+};
+
+template <typename Stream, typename HeapType>
+auto sortedBuild (const Stream left, const HeapType start) -> SortedInstance<typename Stream::ValueType, HeapType>
+{
+	typename HeapType::Builder out(start);
+
+	pushAll(left, [&](const typename Stream::ValueType& a){ out.append(a); return true;});
+
+	return SortedInstance<typename Stream::ValueType, HeapType>(out.freeze());
+}
+
+template <typename Stream>
+auto operator | (Stream left, const Sorted<void>& right) -> SortedInstance<typename Stream::ValueType, Heap<typename Stream::ValueType>>
+{
+	return sortedBuild(left, Heap<typename Stream::ValueType>());
+}
+
+template <typename Stream, typename HeapType>
+auto operator | (Stream left, const Sorted<HeapType>& right) -> SortedInstance<typename Stream::ValueType, HeapType>
+{
+	return sortedBuild(left, right.heap);
+}
+
+//the k smallest elements in order, the same as Sort(compare) | Take(k) 
+//but only a heap of the best k so far is kept while the input is read 
+template <typename F = void>
+struct TopK 
+{
+	const size_t k; 
+	const F compare; 
+
+	TopK (const size_t q, const F f)
+		: k(q), compare(f)
+	{}
+};
+
+template <>
+struct TopK<void> 
+{
+	const size_t k; 
+
+	TopK (const size_t q)
+		: k(q)
+	{}
+};
+
+TopK(size_t) -> TopK<void>;
 
+template <typename Stream, typename F>
+auto operator | (Stream left, const TopK<F>& right) -> SortInstance<typename Stream::ValueType>
+{
+	using Value = typename Stream::ValueType;
+	using Entry = std::pair<Value, size_t>; //value and where it was in the input 
+
+	//any callable works here, unlike Sort nothing below needs a function pointer 
+	const auto compare = [&right](const Value& a, const Value& b) -> bool {
+		if constexpr (std::is_void_v<F>) return ordOverload(a, b);
+		else                             return right.compare(a, b);
+	};
+
+	//ties go to whoever came first, so the result matches a stable sort 
+	const auto less = [compare](const Entry& a, const Entry& b){
+		if(compare(b.first, a.first)) return true;
+		if(compare(a.first, b.first)) return false;
+		return a.second < b.second;
+	};
+
+	//a max heap of the best k, the front is the first to be pushed out 
+	std::vector<Entry> kept;
+	kept.reserve(std::min(right.k, sizeGuess(left)));
+
+	size_t i = 0;
+	if(right.k) pushAll(left, [&](const Value& a){
+		if(kept.size() < right.k)
+		{
+			kept.emplace_back(a, i++);
+			std::push_heap(kept.begin(), kept.end(), less);
+			return true;
+		}
+
+		//anything equal to the front came later and loses the tie 
+		if(compare(kept.front().first, a))
+		{
+			std::pop_heap(kept.begin(), kept.end(), less);
+			kept.pop_back();
+			kept.emplace_back(a, i);
+			std::push_heap(kept.begin(), kept.end(), less);
+		}
+
+		i++;
+		return true;
+	});
+
+	std::sort_heap(kept.begin(), kept.end(), less);
+
+	ListBuilder<Value> out;
+	for(const Entry& a : kept) out.append(a.first);
+
+	return SortInstance<Value>(out.freeze());
+}
 
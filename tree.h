@@ -2,225 +2,474 @@
 #define NIAVE_TREE_H 
 #include "utility.h" 
 #include "list.h"
+#include "ref.h"
+#include "pool.h"
 #include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
 
 //node that holds resource and points to other members
 //shared by different trees (persistent tree)
-template<typename T>
-struct TreeNode
+//Alloc picks where nodes live, see arena.h, Count picks atomic or plain counting
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+struct TreeNode : public Counted<Count, Alloc>
 {
-	using SharedNode = std::shared_ptr<TreeNode<T>>;
+	using SharedNode = Ref<TreeNode>;
 
 	const T res; 
-	const SharedNode left; 
-	const SharedNode right;
-	const int height;
+	SharedNode left;  //children and height are only written by a TreeBuilder
+	SharedNode right; //while it is the node's only owner, and by the destructor
+	int height;
+	int size; //nodes in this subtree, worked out from the children so every constructor keeps it right
 
 	TreeNode (T res , SharedNode l = nullptr 
 						 ,SharedNode  r = nullptr, int h = 1)
-		:res(res), left(l), right(r), height(h)
+		:res(res), left(l), right(r), height(h), size(1 + sizeOf(l) + sizeOf(r))
 	{}
+
+	static int sizeOf (const SharedNode& n)
+	{
+		return n ? n->size : 0;
+	}
+
+	//subtrees nobody else holds are taken apart with an explicit stack,
+	//so even a degenerate chain of nodes is freed without recursing per level
+	~TreeNode (void)
+	{
+		if(!left.unique() && !right.unique())
+			return;
+
+		std::vector<SharedNode> pending;
+
+		if(left.unique())  pending.push_back(std::move(left));
+		if(right.unique()) pending.push_back(std::move(right));
+
+		while(!pending.empty())
+		{
+			const SharedNode n = std::move(pending.back());
+			pending.pop_back();
+
+			if(n->left.unique())  pending.push_back(std::move(n->left));
+			if(n->right.unique()) pending.push_back(std::move(n->right));
+		}
+	}
 };
 
+template <typename T, Ord<T> Compare, typename Alloc, typename Count>
+class TreeBuilder;
+
+//set operations on trees taller than this fork their halves onto the pool, about 2^12 nodes
+constexpr int parallelTreeHeight = 14;
+
+template <typename T, Ord<T> Compare, typename Alloc, typename Count, bool Reverse>
+class TreeStream;
+
+//tag for building a tree straight from input that is already in order, see Tree (FromSorted, ...)
+struct FromSorted {};
+
 //holds a head and some constructors
-template <typename T, Ord<T> Compare = ordOverload>
+template <typename T, Ord<T> Compare = ordOverload, typename Alloc = HeapAlloc, typename Count = DefaultCount>
 class Tree 
 {
+	friend class TreeBuilder<T, Compare, Alloc, Count>;
+	friend class TreeStream<T, Compare, Alloc, Count, false>;
+	friend class TreeStream<T, Compare, Alloc, Count, true>;
 
-	using Node = TreeNode<T>;
-	using SharedNode = std::shared_ptr<TreeNode<T>>;
+	using Node = TreeNode<T, Alloc, Count>;
+	using SharedNode = Ref<Node>;
 	SharedNode head; 
 
 
-	int readHeight (void) const
-	{
-		if (head == nullptr)
-			return 0; 
+	//everything below builds nodes through node, which fills in the height 
+	//so nothing has to patch it up afterwards 
 
-		return head->height;
+	static int heightOf (const SharedNode& n)
+	{
+		return n ? n->height : 0;
 	}
 
-	Tree writeHeight (int h) const
+	static SharedNode node (const T& res, const SharedNode& left, const SharedNode& right)
 	{
-		if (head == nullptr)
-			return *this; 
-
-		return Tree( head->res, head->left, head->right, h);
+		return SharedNode::make(res, left, right, 1 + max(heightOf(left), heightOf(right)));
 	}
 
-	//returns the height of a tree
-	int height (void) const
+	//a copy of n over new children, or n itself when they did not change
+	static SharedNode reuse (const SharedNode& n, const SharedNode& left, const SharedNode& right)
 	{
-		if (head == nullptr)
-			return 0; 
+		if(n->left == left && n->right == right)
+			return n;
 
-		return max( Tree(head->left).readHeight(), Tree(head->right).readHeight()) +1;
+		return node(n->res, left, right);
 	}
 
-	Tree minValueNode (void) const
+	static SharedNode rotateLeft (const SharedNode& n)
 	{
-		if (head->left == nullptr)
-			return *this;
+		const SharedNode& r = n->right;
+		return node(r->res, node(n->res, n->left, r->left), r->right);
+	}
 
-		return Tree(head->left).minValueNode();
+	static SharedNode rotateRight (const SharedNode& n)
+	{
+		const SharedNode& l = n->left;
+		return node(l->res, l->left, node(n->res, l->right, n->right));
 	}
 
+	//push and remove rebuild their search path on the way back up, a level at a time
+	//the nodes handed up from below are brand new and only held here, so rotating them
+	//writes to them in place instead of copying, which leaves one new node per level 
 
-	//returns if the tree is balanced
-	int balanced (void) const
+	static void fix (Node* const n)
 	{
-		if(head == nullptr)
-			return 0;
-
-		const int left = Tree(head->left).height();
-		const int right = Tree(head->right).height();
+		n->height = 1 + max(heightOf(n->left), heightOf(n->right));
+		n->size = 1 + Node::sizeOf(n->left) + Node::sizeOf(n->right);
+	}
 
-		return left - right;
+	//makes n safe to write to
+	static Node* own (SharedNode& n)
+	{
+		if(!n.unique())
+			n = SharedNode::make(n->res, n->left, n->right, n->height);
 
+		return n.get();
 	}
 
-	Tree rotateLeft (void) const
+	//node over left and right, rotated back into shape when one side is two taller 
+	static SharedNode balance (const T& res, SharedNode left, SharedNode right)
 	{
+		if(heightOf(left) > heightOf(right) + 1)
+		{
+			Node* const l = own(left);
 
-		using SharedNode = std::shared_ptr<TreeNode<T>>;
+			if(heightOf(l->left) < heightOf(l->right))
+			{
+				SharedNode top = std::move(l->right);
+				Node* const g = own(top);
 
-		const SharedNode Head = head;
-		const SharedNode A = Head->right;
-		const SharedNode B = (A == nullptr ? nullptr : A->left);
-		const SharedNode C = Head->left;
+				l->right = std::move(g->left);
+				fix(l);
 
-		const SharedNode newLeft = std::make_shared<TreeNode<T>>(Head->res, C, B);
+				g->left = std::move(left);
+				g->right = node(res, g->right, right);
+				fix(g);
 
-		const Tree rotated = Tree(A->res, Tree(newLeft).writeHeight( 1 + max( Tree(newLeft->left).readHeight(), Tree(newLeft->right).readHeight())).head ,A->right);
+				return top;
+			}
 
-		return rotated.writeHeight( max( Tree(rotated.head->left).readHeight(), Tree(rotated.head->right).readHeight()) + 1);
+			l->right = node(res, l->right, right);
+			fix(l);
 
-	};
+			return left;
+		}
 
-	Tree rotateRight (void) const
-	{
-		using SharedNode = std::shared_ptr<TreeNode<T>>;
+		if(heightOf(right) > heightOf(left) + 1)
+		{
+			Node* const r = own(right);
 
-		const SharedNode Head = head;
+			if(heightOf(r->right) < heightOf(r->left))
+			{
+				SharedNode top = std::move(r->left);
+				Node* const g = own(top);
 
-		const SharedNode A = Head->left;
-		const SharedNode B = (A == nullptr ? nullptr : A->right);
-		const SharedNode C = Head->right;
+				r->left = std::move(g->right);
+				fix(r);
 
-		const SharedNode newRight = std::make_shared<TreeNode<T>>(Head->res, B, C);
-		const Tree rotated = Tree(A->res, A->left, Tree(newRight).writeHeight( max( Tree(newRight->left).readHeight(), Tree(newRight->right).readHeight()) + 1).head );
+				g->right = std::move(right);
+				g->left = node(res, left, g->left);
+				fix(g);
 
-		return rotated.writeHeight( max( Tree(rotated.head->left).readHeight(), Tree(rotated.head->right).readHeight() +1));
-	};
+				return top;
+			}
 
-	Tree doubleRotateRight (void) const
-	{
-		return Tree(head->res, Tree(head->left).rotateLeft().head , head->right).rotateRight();
-	};
+			r->left = node(res, left, r->left);
+			fix(r);
 
-	Tree doubleRotateLeft (void) const
-	{
+			return right;
+		}
 
-		return Tree(head->res, head->left, Tree(head->right).rotateRight().head).rotateLeft();
+		return node(res, left, right);
 	}
 
-	Tree insertBalance (const T key) const
+	//n with res added, or n itself when res was already there
+	static SharedNode insert (const SharedNode& n, const T& res)
 	{
+		if(!n)
+			return SharedNode::make(res);
+
+		if(Compare(n->res, res))
+		{
+			SharedNode left = insert(n->left, res);
+			if(left == n->left) return n;
 
-		if (balanced() > 1 && key < head->left->res)
-			return rotateRight();
+			return balance(n->res, std::move(left), n->right);
+		}
 
-		if (balanced() < -1 && key > head->right->res)
-			return rotateLeft();
+		if(Compare(res, n->res))
+		{
+			SharedNode right = insert(n->right, res);
+			if(right == n->right) return n;
 
-		if (balanced() > 1)
-			return doubleRotateRight();
+			return balance(n->res, n->left, std::move(right));
+		}
 
-		if (balanced() < -1)
-			return doubleRotateLeft();
+		return n;
+	}
 
-		return *this;
+	//n without its first element, and that element
+	static std::pair<SharedNode, T> eraseFirst (const SharedNode& n)
+	{
+		if(!n->left)
+			return {n->right, n->res};
 
+		auto [left, first] = eraseFirst(n->left);
+		return {balance(n->res, std::move(left), n->right), first};
 	}
 
-	Tree removeBalance (const T key) const
+	//n with res taken out, or n itself when it was never there
+	static SharedNode erase (const SharedNode& n, const T& res)
 	{
-		if(head == nullptr)
-		{
-			return *this; 
-		}
+		if(!n)
+			return n;
 
-		if (balanced() > 1 && Tree(head->left).balanced() >= 0)
-			return rotateRight();
+		if(Compare(n->res, res))
+		{
+			SharedNode left = erase(n->left, res);
+			if(left == n->left) return n;
 
-		if (balanced() > 1 && Tree(head->left).balanced() < 0)
-			return doubleRotateRight();
+			return balance(n->res, std::move(left), n->right);
+		}
 
-		if (balanced() < -1 && Tree(head->right).balanced() <= 0)
-			return rotateLeft();
+		if(Compare(res, n->res))
+		{
+			SharedNode right = erase(n->right, res);
+			if(right == n->right) return n;
 
-		if (balanced() < -1 && Tree(head->right).balanced() > 0)
-			return doubleRotateLeft();
+			return balance(n->res, n->left, std::move(right));
+		}
 
+		if(!n->left)  return n->right;
+		if(!n->right) return n->left;
 
-		return *this;
+		//the next element up takes its place
+		auto [right, next] = eraseFirst(n->right);
+		return balance(next, n->left, std::move(right));
 	}
 
-	Tree removeOperation (const T res) const
+	//join of the set algebra below, see Blelloch, Ferizovic and Sun, "Just join for parallel ordered sets" 
+	//everything in left comes before res and everything in right after it 
+	//walks down the taller side until the heights meet, so it costs their difference 
+	static SharedNode joinRight (const SharedNode& left, const T& res, const SharedNode& right)
 	{
-		if(head == nullptr)
+		const SharedNode& c = left->right;
+
+		if(heightOf(c) <= heightOf(right) + 1)
 		{
-			*this;
+			const SharedNode t = node(res, c, right);
+
+			if(heightOf(t) <= heightOf(left->left) + 1)
+				return node(left->res, left->left, t);
+
+			return rotateLeft(node(left->res, left->left, rotateRight(t)));
 		}
 
+		const SharedNode t = joinRight(c, res, right);
+		const SharedNode out = node(left->res, left->left, t);
+
+		if(heightOf(t) <= heightOf(left->left) + 1)
+			return out;
+
+		return rotateLeft(out);
+	}
 
-		T y = head->res; 
+	static SharedNode joinLeft (const SharedNode& left, const T& res, const SharedNode& right)
+	{
+		const SharedNode& c = right->left;
 
-		if(Compare(y, res))
+		if(heightOf(c) <= heightOf(left) + 1)
 		{
-			const Tree niaveRemove = Tree(y, Tree(head->left).removeOperation(res).head, head->right);
-			const Tree balanced = niaveRemove.removeBalance(res);
+			const SharedNode t = node(res, left, c);
 
-			return balanced.writeHeight( 1 + max( Tree(balanced.head->left).readHeight(), Tree(balanced.head->right).readHeight())); 
+			if(heightOf(t) <= heightOf(right->right) + 1)
+				return node(right->res, t, right->right);
 
+			return rotateRight(node(right->res, rotateLeft(t), right->right));
 		}
 
-		if(Compare(res, y))
-		{
-			const Tree niaveRemove = Tree(y, head->left, Tree(head->right).removeOperation(res).head);
-			const Tree balanced = niaveRemove.removeBalance(res);
+		const SharedNode t = joinLeft(left, res, c);
+		const SharedNode out = node(right->res, t, right->right);
 
-			return balanced.writeHeight( 1 + max( Tree(balanced.head->left).readHeight(), Tree(balanced.head->right).readHeight())); 
-		}
+		if(heightOf(t) <= heightOf(right->right) + 1)
+			return out;
+
+		return rotateRight(out);
+	}
+
+	static SharedNode join (const SharedNode& left, const T& res, const SharedNode& right)
+	{
+		if(heightOf(left) > heightOf(right) + 1)
+			return joinRight(left, res, right);
 
+		if(heightOf(right) > heightOf(left) + 1)
+			return joinLeft(left, res, right);
 
-		if(head->left == nullptr && head->right == nullptr)
+		return node(res, left, right);
+	}
+
+	//everything before res, whether res was there, and everything after it
+	static std::tuple<SharedNode, bool, SharedNode> split (const SharedNode& n, const T& res)
+	{
+		if(!n)
+			return {nullptr, false, nullptr};
+
+		if(Compare(n->res, res))
 		{
-			return Tree(nullptr);
+			const auto [l, found, r] = split(n->left, res);
+			return {l, found, join(r, n->res, n->right)};
 		}
 
-		if( head->left == nullptr || head->right == nullptr)
+		if(Compare(res, n->res))
 		{
+			const auto [l, found, r] = split(n->right, res);
+			return {join(n->left, n->res, l), found, r};
+		}
 
-			const Tree temp = head->left == nullptr ? Tree(head->right) : Tree(head->left);
+		return {n->left, true, n->right};
+	}
 
-			return temp.writeHeight( 1 + max( Tree(temp.head->left).readHeight(), Tree(temp.head->right).readHeight()));
+	//n without its last element, and that element
+	static std::pair<SharedNode, T> splitLast (const SharedNode& n)
+	{
+		if(!n->right)
+			return {n->left, n->res};
 
-		}
+		const auto [rest, last] = splitLast(n->right);
+		return {join(n->left, n->res, rest), last};
+	}
+
+	static std::pair<SharedNode, SharedNode> splitAt (const SharedNode& n, const int k)
+	{
+		if(!n)
+			return {nullptr, nullptr};
 
-		//two child case 
-		else 
+		const int left = Node::sizeOf(n->left);
+
+		if(k <= left)
 		{
+			const auto [l, r] = splitAt(n->left, k);
+			return {l, join(r, n->res, n->right)};
+		}
+
+		const auto [l, r] = splitAt(n->right, k - left - 1);
+		return {join(n->left, n->res, l), r};
+	}
 
-			const Tree temp = Tree(head->right).minValueNode();
-			const Tree remmed = Tree(temp.head->res, head->left, Tree(head->right).remove(temp.head->res).head);
+	//join without a middle element
+	static SharedNode join (const SharedNode& left, const SharedNode& right)
+	{
+		if(!left)
+			return right;
 
-			return remmed.writeHeight( 1 + max( Tree(remmed.head->left).readHeight(),  Tree(remmed.head->right).readHeight()));
+		const auto [rest, last] = splitLast(left);
+		return join(rest, last, right);
+	}
 
-		}
+	//runs the two halves of a set operation, on the pool when both are big enough to be worth it
+	template <typename F, typename G>
+	static std::pair<SharedNode, SharedNode> both (Pool* const pool, const SharedNode& n, F left, G right)
+	{
+		if(pool && heightOf(n) > parallelTreeHeight)
+			return pool->both(left, right);
 
+		return {left(), right()};
 	}
 
+	//O(m log(n/m + 1)) for sizes m <= n, each keeps the nodes of a it can
+	static SharedNode unite (const SharedNode& a, const SharedNode& b, Pool* const pool)
+	{
+		if(!a) return b;
+		if(!b) return a;
+
+		const auto [l, found, r] = split(b, a->res);
+		const auto [left, right] = both(pool, a, 
+				[&, l = l](){ return unite(a->left, l, pool);}, 
+				[&, r = r](){ return unite(a->right, r, pool);});
+
+		if(heightOf(left) == heightOf(a->left) && heightOf(right) == heightOf(a->right))
+			return reuse(a, left, right);
+
+		return join(left, a->res, right);
+	}
+
+	static SharedNode intersect (const SharedNode& a, const SharedNode& b, Pool* const pool)
+	{
+		if(!a || !b) return nullptr;
+
+		const auto [l, found, r] = split(b, a->res);
+		const auto [left, right] = both(pool, a, 
+				[&, l = l](){ return intersect(a->left, l, pool);}, 
+				[&, r = r](){ return intersect(a->right, r, pool);});
+
+		if(!found)
+			return join(left, right);
+
+		if(left == a->left && right == a->right)
+			return a;
+
+		return join(left, a->res, right);
+	}
+
+	static SharedNode difference (const SharedNode& a, const SharedNode& b, Pool* const pool)
+	{
+		if(!a) return nullptr;
+		if(!b) return a;
+
+		const auto [l, found, r] = split(b, a->res);
+		const auto [left, right] = both(pool, a, 
+				[&, l = l](){ return difference(a->left, l, pool);}, 
+				[&, r = r](){ return difference(a->right, r, pool);});
+
+		if(found)
+			return join(left, right);
+
+		if(left == a->left && right == a->right)
+			return a;
+
+		return join(left, a->res, right);
+	}
+
+	template <typename F>
+	static SharedNode filter (const SharedNode& a, const F& keep, Pool* const pool)
+	{
+		if(!a) return nullptr;
+
+		const auto [left, right] = both(pool, a, 
+				[&](){ return filter(a->left, keep, pool);}, 
+				[&](){ return filter(a->right, keep, pool);});
+
+		if(!keep(a->res))
+			return join(left, right);
+
+		if(left == a->left && right == a->right)
+			return a;
+
+		return join(left, a->res, right);
+	}
+
+	//the next n elements from next(), in order, as a perfectly balanced tree
+	//the middle element is taken after the left half is built, so the input is read front to back once 
+	template <typename F>
+	static SharedNode balanced (const int n, F& next)
+	{
+		if(n == 0)
+			return nullptr;
+
+		const SharedNode left = balanced(n / 2, next);
+		const T res = next();
+		const SharedNode right = balanced(n - n / 2 - 1, next);
+
+		return node(res, left, right);
+	}
 
 public:
 	Tree (const SharedNode h)
@@ -228,11 +477,11 @@ public:
 	{}
 
 	explicit Tree (T res)
-		: head(std::make_shared<Node>(res))
+		: head(SharedNode::make(res))
 	{}
 
 	explicit Tree (T res, SharedNode left, SharedNode right, int h = 1)
-		: head(std::make_shared<Node>(res, left, right, h))
+		: head(SharedNode::make(res, left, right, h))
 	{}
 
 	explicit Tree (void)
@@ -247,11 +496,56 @@ public:
 		: head(a.head)
 	{}
 
-	Tree (const List<T> l)
-		: Tree( l.foldr( [](const T i, const Tree<T> a){return a.push(i);}, Tree<T>()))
+	template <typename N>
+	Tree (const List<T, N> l)
+		: Tree()
+	{
+		TreeBuilder<T, Compare, Alloc, Count> out;
+		l.foldr([&](const T& a){ out.push(a);});
+
+		head = out.freeze().head;
+	}
+
+
+	//O(n), l must already be in Compare order, runs of equal elements keep their first
+	template <typename N>
+	Tree (FromSorted, const List<T, N> l)
+		: Tree()
 	{
+		int n = 0;
+		std::optional<T> last;
+
+		l.foldr([&](const T& a){
+			if(!last || Compare(a, *last)) n++;
+			last.emplace(a);
+		});
+
+		List<T, N> rest = l;
+		auto next = [&](){
+			const T res = rest.peek();
+			do rest = rest.pop(); while(rest && !Compare(rest.peek(), res));
+			return res;
+		};
+
+		head = balanced(n, next);
 	}
 
+	Tree (FromSorted, const std::vector<T>& v)
+		: Tree()
+	{
+		int n = 0;
+		for(size_t i = 0; i < v.size(); i++)
+			if(i == 0 || Compare(v[i], v[i - 1])) n++;
+
+		size_t at = 0;
+		auto next = [&](){
+			const T& res = v[at];
+			do at++; while(at < v.size() && !Compare(v[at], res));
+			return res;
+		};
+
+		head = balanced(n, next);
+	}
 
 	Tree& operator = (const Tree& a)
 	{
@@ -259,71 +553,104 @@ public:
 		return *this;
 	}
 
+	//every element in order followed by list, one pass with an explicit stack of ancestors
 	List<T> toList (const List<T> list = List<T>()) const
 	{
-		if (head == nullptr)
-			return list;
+		ListBuilder<T> out;
+		std::vector<const Node*> path;
 
-		//lmao autism
-		//make + overloads 
-		const auto left  = Tree(head->left).toList(list);
-		const auto right = Tree(head->right).toList(list);
+		for(const Node* n = head.get(); n || !path.empty();)
+		{
+			if(n)
+			{
+				path.push_back(n);
+				n = n->left.get();
+				continue;
+			}
+
+			n = path.back();
+			path.pop_back();
+
+			out.append(n->res);
+			n = n->right.get();
+		}
 
-		return left + head->res + right;
+		return out.freeze(list);
 	}
 
 
 	//returns the number of elements in a tree
 	int size (void) const
 	{
-		if(head == nullptr)
-			return 0;
-
-		return 1 + Tree(head->left).size() + Tree(head->right).size();
+		return Node::sizeOf(head);
 	}
 
-
-	Tree push (const T res) const
+	//the k'th smallest element, counting from 0
+	T nth (int k) const
 	{
-		if (head == nullptr)
-			return Tree(res);
-
-		T y = head->res; 
+		if(k < 0 || k >= size())
+			throw std::out_of_range("nth element out of range");
 
-		if( Compare(head->res, res))
+		const Node* n = head.get();
+		while(true)
 		{
-			const Tree niaveInsert = Tree(y, Tree(head->left).push(res).head, head->right);
-			const Tree balanced = niaveInsert.insertBalance(res);
-			const Tree updatedHeight = balanced.writeHeight( 1 + max( Tree(balanced.head->left).readHeight(), Tree(balanced.head->right).readHeight()));
-
-			return updatedHeight;
+			const int left = Node::sizeOf(n->left);
+
+			if(k == left)
+				return n->res;
+
+			if(k < left)
+				n = n->left.get();
+			else
+			{
+				k -= left + 1;
+				n = n->right.get();
+			}
 		}
+	}
 
-		if( Compare(res, head->res))
-		{
-
-			const Tree niaveInsert = Tree(y, head->left , Tree(head->right).push(res).head);
-			const Tree balanced = niaveInsert.insertBalance(res);
-			const Tree updatedHeight = balanced.writeHeight( 1 + max( Tree(balanced.head->left).readHeight(), Tree(balanced.head->right).readHeight()));
+	//how many elements come before res, which is where it is or would go
+	int rank (const T res) const
+	{
+		int before = 0;
 
-			return updatedHeight;
+		for(const Node* n = head.get(); n;)
+		{
+			if(Compare(n->res, res))
+				n = n->left.get();
+			else if(Compare(res, n->res))
+			{
+				before += Node::sizeOf(n->left) + 1;
+				n = n->right.get();
+			}
+			else
+				return before + Node::sizeOf(n->left);
 		}
 
-		return *this;
+		return before;
 	}
 
-	/*
-	Tree push (const Tree a) const 
+	//the first k elements and the rest, O(log n)
+	std::pair<Tree, Tree> splitAt (const int k) const
 	{
-	*/
+		if(k < 0 || k > size())
+			throw std::out_of_range("splitting a Tree out of range");
 
+		const auto [left, right] = splitAt(head, k);
+		return {Tree(left), Tree(right)};
+	}
 
-	Tree remove (const T res) const
+
+	//copies the search path, one node per level, and gives back this same tree if res is already in it
+	Tree push (const T res) const
 	{
-		if (!contains(res))
-			return *this;
+		return Tree(insert(head, res));
+	}
 
-		return removeOperation(res);
+	//one pass down, gives back this same tree if res is not in it
+	Tree remove (const T res) const
+	{
+		return Tree(erase(head, res));
 	}
 
 	bool contains (const T res) const
@@ -364,10 +691,181 @@ public:
 
 		return head->res;
 	}
-	
+
+	//everything in either, elements of this tree win ties 
+	Tree unite (const Tree& a) const
+	{
+		return Tree(unite(head, a.head, nullptr));
+	}
+
+	Tree unite (const Tree& a, const Parallel p) const
+	{
+		return Tree(unite(head, a.head, &p.pool));
+	}
+
+	//everything in both, taken from this tree 
+	Tree intersect (const Tree& a) const
+	{
+		return Tree(intersect(head, a.head, nullptr));
+	}
+
+	Tree intersect (const Tree& a, const Parallel p) const
+	{
+		return Tree(intersect(head, a.head, &p.pool));
+	}
+
+	//everything in this tree but not in a 
+	Tree difference (const Tree& a) const
+	{
+		return Tree(difference(head, a.head, nullptr));
+	}
+
+	Tree difference (const Tree& a, const Parallel p) const
+	{
+		return Tree(difference(head, a.head, &p.pool));
+	}
+
+	//everything fun keeps, O(n) but subtrees that keep everything are shared 
+	template <typename F>
+	Tree filter (const F fun) const
+	{
+		return Tree(filter(head, fun, nullptr));
+	}
+
+	template <typename F>
+	Tree filter (const F fun, const Parallel p) const
+	{
+		return Tree(filter(head, fun, &p.pool));
+	}
 };
 
 
+//transient tree, inserts by rebalancing nodes in place while it is their only owner
+//and copies a node first when someone else can still see it, 
+//so it can start from any Tree and freeze back into one in O(1)
+template <typename T, Ord<T> Compare = ordOverload, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class TreeBuilder 
+{
+	using Node = TreeNode<T, Alloc, Count>;
+	using SharedNode = Ref<Node>;
+
+	SharedNode root; 
+
+	static int height (const SharedNode& n)
+	{
+		return n ? n->height : 0;
+	}
+
+	static void fix (Node* const n)
+	{
+		n->height = 1 + max(height(n->left), height(n->right));
+		n->size = 1 + Node::sizeOf(n->left) + Node::sizeOf(n->right);
+	}
+
+	//makes n safe to write to
+	static Node* own (SharedNode& n)
+	{
+		if(!n.unique())
+			n = SharedNode::make(n->res, n->left, n->right, n->height);
+
+		return n.get();
+	}
+
+	static void rotateRight (SharedNode& n)
+	{
+		own(n->left);
+
+		SharedNode l = std::move(n->left);
+		n->left = std::move(l->right);
+		fix(n.get());
+
+		l->right = std::move(n);
+		fix(l.get());
+
+		n = std::move(l);
+	}
+
+	static void rotateLeft (SharedNode& n)
+	{
+		own(n->right);
+
+		SharedNode r = std::move(n->right);
+		n->right = std::move(r->left);
+		fix(n.get());
+
+		r->left = std::move(n);
+		fix(r.get());
+
+		n = std::move(r);
+	}
+
+	//n is already owned
+	static void rebalance (SharedNode& n)
+	{
+		const int balance = height(n->left) - height(n->right);
+
+		if(balance > 1)
+		{
+			if(height(n->left->left) < height(n->left->right))
+				rotateLeft(n->left);
+
+			return rotateRight(n);
+		}
+
+		if(balance < -1)
+		{
+			if(height(n->right->right) < height(n->right->left))
+				rotateRight(n->right);
+
+			return rotateLeft(n);
+		}
+
+		fix(n.get());
+	}
+
+	static void insert (SharedNode& n, const T& res)
+	{
+		if(!n)
+		{
+			n = SharedNode::make(res);
+			return;
+		}
+
+		if(Compare(n->res, res))
+		{
+			insert(own(n)->left, res);
+			return rebalance(n);
+		}
+
+		if(Compare(res, n->res))
+		{
+			insert(own(n)->right, res);
+			return rebalance(n);
+		}
+	}
+
+	public:
+
+	TreeBuilder (void)
+		: root(nullptr)
+	{}
+
+	explicit TreeBuilder (const Tree<T, Compare, Alloc, Count> t)
+		: root(t.head)
+	{}
+
+	void push (const T res)
+	{
+		insert(root, res);
+	}
+
+	//the tree shares our nodes, so anything pushed afterwards copies them again first
+	Tree<T, Compare, Alloc, Count> freeze (void) const
+	{
+		return Tree<T, Compare, Alloc, Count>(root);
+	}
+};
+
 /*
 //should these be implicit conversions?
 //also these are all unbalancing if the list gets sorted
@@ -0,0 +1,537 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <new>
+#include <optional>
+#include <iostream>
+#include <stdexcept>
+#include <initializer_list>
+#include <utility>
+#include "ref.h"
+
+//persistent vector, a 32 way trie of blocks plus a loose tail block
+//index, update, push_back and pop_back copy one path of at most log32(n) blocks
+//everything else is shared between versions
+//
+//the trie only ever holds full leaves, the last 1..32 elements live in the tail
+//so most push_backs only copy the tail
+
+//one block of the trie, either 32 children or 32 elements
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+struct VectorNode : public Counted<Count, Alloc>
+{
+	using Link = Ref<VectorNode>;
+
+	static constexpr int bits  = 5;
+	static constexpr int width = 1 << bits;
+	static constexpr int mask  = width - 1;
+
+	const bool leaf;
+	int size; //constructed slots, only grows while a builder or a copy fills the block
+
+	alignas(T) alignas(Link) unsigned char slots[width * (sizeof(T) > sizeof(Link) ? sizeof(T) : sizeof(Link))];
+
+	explicit VectorNode (const bool l)
+		: leaf(l), size(0)
+	{}
+
+	//copy of the first n slots of a
+	VectorNode (const VectorNode& a, const int n)
+		: leaf(a.leaf), size(0)
+	{
+		for(; size < n; size++)
+		{
+			if(leaf) new (value(size)) T(*a.value(size));
+			else     new (child(size)) Link(*a.child(size));
+		}
+	}
+
+	VectorNode (const VectorNode&) = delete;
+
+	~VectorNode (void)
+	{
+		for(int i = 0; i < size; i++)
+		{
+			if(leaf) value(i)->~T();
+			else     child(i)->~Link();
+		}
+	}
+
+	T* value (const int i) const
+	{
+		return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(slots)) + i);
+	}
+
+	Link* child (const int i) const
+	{
+		return std::launder(reinterpret_cast<Link*>(const_cast<unsigned char*>(slots)) + i);
+	}
+
+	void append (const T r)
+	{
+		new (value(size)) T(r);
+		size++;
+	}
+
+	void append (const Link l)
+	{
+		new (child(size)) Link(l);
+		size++;
+	}
+};
+
+template<typename T, typename Alloc, typename Count>
+class VectorBuilder;
+
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class Vector
+{
+	public:
+	using DataType = T;
+	using Node = VectorNode<T, Alloc, Count>;
+	using Link = typename Node::Link;
+
+	private:
+	friend class VectorBuilder<T, Alloc, Count>;
+
+	static constexpr int bits  = Node::bits;
+	static constexpr int width = Node::width;
+	static constexpr int mask  = Node::mask;
+
+	int count;
+	int shift; //depth of the trie in bits, the root splits on (i >> shift) & mask
+	Link root; //null while everything fits in the tail
+	Link tail;
+
+	Vector (const int c, const int s, const Link r, const Link t)
+		: count(c), shift(s), root(r), tail(t)
+	{}
+
+	//index of the first element in the tail
+	int tailOffset (void) const
+	{
+		return count < width ? 0 : ((count - 1) >> bits) << bits;
+	}
+
+	//the block holding element i
+	const Node* leafFor (const int i) const
+	{
+		if(i >= tailOffset())
+			return tail.get();
+
+		const Node* n = root.get();
+		for(int level = shift; level > 0; level -= bits)
+			n = n->child((i >> level) & mask)->get();
+
+		return n;
+	}
+
+	static Link copy (const Node& a, const int n)
+	{
+		return Link::make(a, n);
+	}
+
+	//a chain of single child blocks down to leaf
+	static Link path (const int level, const Link leaf)
+	{
+		if(level == 0)
+			return leaf;
+
+		Link n = Link::make(false);
+		n->append(path(level - bits, leaf));
+
+		return n;
+	}
+
+	//copy of the right spine with a full leaf hung off its end
+	Link pushTail (const int level, const Node* parent, const Link leaf) const
+	{
+		const int sub = ((count - 1) >> level) & mask;
+		Link out = parent ? copy(*parent, parent->size) : Link::make(false);
+
+		if(level == bits)
+		{
+			out->append(leaf);
+			return out;
+		}
+
+		if(sub < out->size)
+		{
+			*out->child(sub) = pushTail(level - bits, out->child(sub)->get(), leaf);
+			return out;
+		}
+
+		out->append(path(level - bits, leaf));
+		return out;
+	}
+
+	//copy of the right spine without its last leaf, null when nothing is left
+	Link popTail (const int level, const Node* n) const
+	{
+		const int sub = ((count - 2) >> level) & mask;
+
+		if(level > bits)
+		{
+			const Link child = popTail(level - bits, n->child(sub)->get());
+
+			if(!child && sub == 0)
+				return nullptr;
+
+			Link out = copy(*n, sub);
+			if(child) out->append(child);
+
+			return out;
+		}
+
+		if(sub == 0)
+			return nullptr;
+
+		return copy(*n, sub);
+	}
+
+	//keeps the first n elements of the subtree under node, n is a multiple of 32
+	//so leaves are never cut and the recursion stops above them
+	static Link trim (const int level, const Node* node, const int n)
+	{
+		const int last = ((n - 1) >> level) & mask;
+		Link out = copy(*node, last + 1);
+
+		const int rest = n - (last << level);
+		if(rest < (1 << level))
+			*out->child(last) = trim(level - bits, out->child(last)->get(), rest);
+
+		return out;
+	}
+
+	static Link setIn (const int level, const Node* n, const int i, const T r)
+	{
+		Link out = copy(*n, n->size);
+
+		if(level == 0)
+		{
+			*out->value(i & mask) = r;
+			return out;
+		}
+
+		const int sub = (i >> level) & mask;
+		*out->child(sub) = setIn(level - bits, n->child(sub)->get(), i, r);
+
+		return out;
+	}
+
+	public:
+
+	Vector (void)
+		: count(0), shift(bits), root(nullptr), tail(nullptr)
+	{}
+
+	Vector (const std::initializer_list<T> l);
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	operator bool (void) const
+	{
+		return count;
+	}
+
+	T operator [] (const int i) const
+	{
+		if(i < 0 || i >= count)
+			throw std::out_of_range("[] trying to access an out of range element");
+
+		return *leafFor(i)->value(i & mask);
+	}
+
+	T peek_back (void) const
+	{
+		return (*this)[count - 1];
+	}
+
+	//copy with element i replaced
+	Vector update (const int i, const T r) const
+	{
+		if(i < 0 || i >= count)
+			throw std::out_of_range("update of an out of range element");
+
+		if(i >= tailOffset())
+		{
+			Link t = copy(*tail, tail->size);
+			*t->value(i & mask) = r;
+
+			return Vector(count, shift, root, t);
+		}
+
+		return Vector(count, shift, setIn(shift, root.get(), i, r), tail);
+	}
+
+	Vector push_back (const T r) const
+	{
+		//room in the tail
+		if(count - tailOffset() < width)
+		{
+			Link t = tail ? copy(*tail, tail->size) : Link::make(true);
+			t->append(r);
+
+			return Vector(count + 1, shift, root, t);
+		}
+
+		Link t = Link::make(true);
+		t->append(r);
+
+		//the full tail goes into the trie, growing a level when the root is full
+		if((count >> bits) > (1 << shift))
+		{
+			Link top = Link::make(false);
+			top->append(root);
+			top->append(path(shift, tail));
+
+			return Vector(count + 1, shift + bits, top, t);
+		}
+
+		return Vector(count + 1, shift, pushTail(shift, root.get(), tail), t);
+	}
+
+	Vector pop_back (void) const
+	{
+		if(count == 0)
+			throw std::out_of_range("pop_back on an empty Vector");
+
+		if(count == 1)
+			return Vector();
+
+		if(count - tailOffset() > 1)
+			return Vector(count - 1, shift, root, copy(*tail, tail->size - 1));
+
+		//the tail is used up, the last leaf of the trie takes its place
+		const Link t = leaf(count - 2);
+		Link r = popTail(shift, root.get());
+		int s = r ? shift : bits;
+
+		if(s > bits && r->size == 1)
+		{
+			r = *r->child(0);
+			s -= bits;
+		}
+
+		return Vector(count - 1, s, r, t);
+	}
+
+	//first n elements, only the right spine is copied
+	Vector take (const int n) const
+	{
+		if(n < 0 || n > count)
+			throw std::out_of_range("taking more than a Vector holds");
+
+		if(n == count)
+			return *this;
+
+		if(n == 0)
+			return Vector();
+
+		const int offset = n < width ? 0 : ((n - 1) >> bits) << bits;
+
+		if(offset == tailOffset())
+			return Vector(n, shift, root, copy(*tail, n - offset));
+
+		const Link t = n - offset == width ? leaf(n - 1) : copy(*leafFor(n - 1), n - offset);
+
+		if(offset == 0)
+			return Vector(n, bits, nullptr, t);
+
+		Link r = trim(shift, root.get(), offset);
+		int s = shift;
+
+		while(s > bits && r->size == 1)
+		{
+			r = *r->child(0);
+			s -= bits;
+		}
+
+		return Vector(n, s, r, t);
+	}
+
+	Vector slice (const int start, std::optional<int> endp = std::nullopt) const;
+
+	template <typename F>
+	void walk (F fun) const
+	{
+		for(int i = 0; i < count; i += width)
+		{
+			const Node* leaf = leafFor(i);
+
+			for(int j = 0; j < leaf->size; j++)
+				fun(*leaf->value(j));
+		}
+	}
+
+	bool operator == (const Vector& a) const
+	{
+		if(count != a.count)
+			return false;
+
+		for(int i = 0; i < count; i += width)
+		{
+			const Node* x = leafFor(i);
+			const Node* y = a.leafFor(i);
+
+			if(x == y) continue;
+
+			for(int j = 0; j < x->size; j++)
+				if(*x->value(j) != *y->value(j))
+					return false;
+		}
+
+		return true;
+	}
+
+	bool operator != (const Vector& a) const
+	{
+		return !(*this == a);
+	}
+
+	//the block holding element i, for streams walking a leaf at a time
+	Link leaf (const int i) const
+	{
+		if(i >= tailOffset())
+			return tail;
+
+		const Node* n = root.get();
+		for(int level = shift; level > bits; level -= bits)
+			n = n->child((i >> level) & mask)->get();
+
+		return *n->child((i >> bits) & mask);
+	}
+};
+
+//fills a vector in place, the blocks are only ever seen by the builder until seal
+template<typename T, typename Alloc = HeapAlloc, typename Count = DefaultCount>
+class VectorBuilder
+{
+	using V = Vector<T, Alloc, Count>;
+	using Node = typename V::Node;
+	using Link = typename V::Link;
+
+	static constexpr int bits  = Node::bits;
+	static constexpr int width = Node::width;
+	static constexpr int mask  = Node::mask;
+
+	int count = 0;
+	int shift = bits;
+	Link root;
+	Link tail;
+
+	//hangs a full leaf off the right spine, every block on it belongs to us
+	void pushTail (void)
+	{
+		if(!root)
+		{
+			root = Link::make(false);
+			root->append(tail);
+			return;
+		}
+
+		const int offset = count - width;
+
+		if((offset >> bits) >= (1 << shift))
+		{
+			Link top = Link::make(false);
+			top->append(root);
+			top->append(V::path(shift, tail));
+
+			root = top;
+			shift += bits;
+			return;
+		}
+
+		Node* n = root.get();
+		for(int level = shift; level > bits; level -= bits)
+		{
+			const int sub = (offset >> level) & mask;
+
+			if(sub == n->size)
+			{
+				n->append(V::path(level - bits, tail));
+				return;
+			}
+
+			n = n->child(sub)->get();
+		}
+
+		n->append(tail);
+	}
+
+	public:
+
+	void append (const T r)
+	{
+		if(tail && tail->size == width)
+			pushTail();
+
+		if(!tail || tail->size == width)
+			tail = Link::make(true);
+
+		tail->append(r);
+		count++;
+	}
+
+	int length (void) const
+	{
+		return count;
+	}
+
+	V seal (void)
+	{
+		const V out(count, shift, root, tail);
+
+		count = 0;
+		shift = bits;
+		root = nullptr;
+		tail = nullptr;
+
+		return out;
+	}
+};
+
+template<typename T, typename Alloc, typename Count>
+Vector<T, Alloc, Count>::Vector (const std::initializer_list<T> l)
+	: Vector()
+{
+	VectorBuilder<T, Alloc, Count> out;
+	for(const T& a : l) out.append(a);
+
+	*this = out.seal();
+}
+
+//elements start through end, a prefix is O(log n), anything else is rebuilt
+template<typename T, typename Alloc, typename Count>
+Vector<T, Alloc, Count> Vector<T, Alloc, Count>::slice (const int start, std::optional<int> endp) const
+{
+	const int end = endp ? *endp : count - 1;
+
+	if(start < 0 || end + 1 > count)
+		throw std::out_of_range("trying to slice out of range");
+
+	if(start > end)
+		throw std::out_of_range("start of slice is after end");
+
+	if(start == 0)
+		return take(end + 1);
+
+	VectorBuilder<T, Alloc, Count> out;
+	for(int i = start; i <= end; i++)
+		out.append((*this)[i]);
+
+	return out.seal();
+}
+
+template<typename T, typename A, typename C>
+std::ostream& operator<< (std::ostream& os, const Vector<T, A, C>& v)
+{
+	v.walk([&](const T& a){ os << a << ',';});
+	return os;
+}
+
+#endif